@@ -6,21 +6,16 @@
 using namespace std;
 
 Citizen::Citizen(const string &username, const string &password, const ResidentStatus &resident_status)
-    : User(username, password), resident_status(resident_status), booked_hours(0) {}
+    : User(username, password, resident_status == RESIDENT ? User::RESIDENT : User::NONRESIDENT) {}
 
-Citizen::ResidentStatus Citizen::get_resident_status() const
-{
-  return resident_status;
-}
-
-int Citizen::get_booked_hours() const
+shared_ptr<Citizen> Citizen::from_user(const shared_ptr<User> &user)
 {
-  return booked_hours;
+  return user && user->is_citizen() ? static_pointer_cast<Citizen>(user) : nullptr;
 }
 
-void Citizen::set_booked_hours(const int &booked_hours)
+Citizen::ResidentStatus Citizen::get_resident_status() const
 {
-  this->booked_hours = booked_hours;
+  return get_category() == User::RESIDENT ? RESIDENT : NONRESIDENT;
 }
 
 void Citizen::display_my_tickets()
@@ -37,17 +32,17 @@ void Citizen::display_my_tickets()
 void Citizen::display_my_events()
 {
   cout << "My reserved events: " << endl;
-  if (my_events.size() == 0)
+  if (get_my_events().size() == 0)
     cout << "No reserved events." << endl;
   else
-    for (const Event &event : my_events)
-      cout << event << endl
+    for (const shared_ptr<Event> &event : get_my_events())
+      cout << *event << endl
            << endl;
 }
 
 bool Citizen::has_overbooked(const int &hours)
 {
-  return booked_hours + hours > 24;
+  return get_booked_hours() + hours > 24;
 }
 
 void Citizen::display_menu()
@@ -67,6 +62,7 @@ void Citizen::display_menu()
 
 void Citizen::handle_menu_input(Facility &facility)
 {
+  shared_ptr<Citizen> self = static_pointer_cast<Citizen>(shared_from_this());
   int option;
   while (true)
   {
@@ -79,22 +75,24 @@ void Citizen::handle_menu_input(Facility &facility)
       facility.display_schedule();
       break;
     case 2:
-      facility.request_event(make_shared<Citizen>(*this));
+      facility.request_event(self);
       break;
     case 3:
-      facility.request_ticket(make_shared<Citizen>(*this));
+      facility.request_ticket(self);
       break;
     case 4:
+      facility.load_event_history();
       display_my_tickets();
       break;
     case 5:
+      facility.load_event_history();
       display_my_events();
       break;
     case 6:
-      facility.cancel_event(make_shared<Citizen>(*this));
+      facility.cancel_event(self);
       break;
     case 7:
-      facility.refund_ticket(make_shared<Citizen>(*this));
+      facility.refund_ticket(self);
       break;
     case 8:
       User::claim_balance();
@@ -108,6 +106,7 @@ void Citizen::handle_menu_input(Facility &facility)
       cout << "Invalid option. Please try again." << endl;
       continue; // Skip the rest of the loop and redisplay the menu
     }
+    facility.commit_journal();
     while (true)
     {
       string return_to_menu;
@@ -142,13 +141,3 @@ void Citizen::remove_ticket(const Ticket &ticket)
 {
   my_tickets.erase(remove(my_tickets.begin(), my_tickets.end(), ticket), my_tickets.end());
 }
-
-void Citizen::add_event(const Event &event)
-{
-  my_events.push_back(event);
-}
-
-void Citizen::remove_event(const Event &event)
-{
-  my_events.erase(remove(my_events.begin(), my_events.end(), event), my_events.end());
-}
@@ -22,6 +22,14 @@ public:
   Citizen(const string &username, const string &password, const ResidentStatus &resident_status);
   ~Citizen() = default;
 
+  /**
+   * Gets a User as a Citizen, going by its Category rather than a dynamic cast.
+   *
+   * @param user the User
+   * @return the Citizen, or nullptr if the User is not one
+   */
+  static shared_ptr<Citizen> from_user(const shared_ptr<User> &user);
+
   // getters and setters
   /**
    * Gets the ResidentStatus of this Citizen.
@@ -29,18 +37,6 @@ public:
    * @return the ResidentStatus
    */
   ResidentStatus get_resident_status() const;
-  /**
-   * Gets the number of booked hours from this User.
-   *
-   * @return the number of booked hours from this User
-   */
-  int get_booked_hours() const;
-  /**
-   * Sets the number of booked hours for this User.
-   *
-   * @param booked_hours the new number of booked hours
-   */
-  void set_booked_hours(const int &booked_hours);
 
   // helper functions for the menu
   /**
@@ -50,7 +46,7 @@ public:
   /**
    * Displays the Events that this User has created.
    */
-  void display_my_events();
+  virtual void display_my_events() override;
   /**
    * Gets if this User will have overbooked.
    *
@@ -69,16 +65,6 @@ public:
    */
   void remove_ticket(const Ticket &ticket);
 
-  /**
-   * Adds an Event to this User's list of events.
-   */
-  void add_event(const Event &event);
-
-  /**
-   * Removes an Event from this User's list of events.
-   */
-  void remove_event(const Event &event);
-
   // menu functions
   /**
    * Displays the menu options for the User.
@@ -90,8 +76,5 @@ public:
   virtual void handle_menu_input(Facility &facility) override;
 
 private:
-  ResidentStatus resident_status;
   vector<Ticket> my_tickets; // tickets that the user has successfully bought
-  vector<Event> my_events;   // events that the user has successfully reserved
-  int booked_hours;
 };
\ No newline at end of file
@@ -1,54 +1,23 @@
 #include "Client.hpp"
 #include "Facility.hpp"
 #include <limits>
-#include <algorithm>
 
 using namespace std;
 
 Client::Client(const string &username, const string &password, const ClientType &client_type)
-    : User(username, password), client_type(client_type), booked_hours(0) {}
+    : User(username, password, client_type == CITY ? User::CITY : User::ORGANIZATION) {}
 
 Client::ClientType Client::get_client_type() const
 {
-  return client_type;
-}
-
-int Client::get_booked_hours() const
-{
-  return booked_hours;
-}
-
-void Client::set_booked_hours(const int &booked_hours)
-{
-  this->booked_hours = booked_hours;
-}
-
-void Client::add_event(const Event &event)
-{
-  my_events.push_back(event);
-}
-
-void Client::remove_event(const Event &event)
-{
-  my_events.erase(remove(my_events.begin(), my_events.end(), event), my_events.end());
-}
-
-void Client::display_my_events()
-{
-  cout << "My reserved events: " << endl;
-  if (my_events.size() == 0)
-    cout << "No reserved events." << endl;
-  else
-    for (const Event &event : my_events)
-      cout << event << endl;
+  return get_category() == User::CITY ? CITY : ORGANIZATION;
 }
 
 bool Client::has_overbooked(const int &hours)
 {
-  if (client_type == CITY)
-    return booked_hours + hours > 48;
+  if (get_category() == User::CITY)
+    return get_booked_hours() + hours > 48;
   else
-    return booked_hours + hours > 36; // Organization
+    return get_booked_hours() + hours > 36; // Organization
 }
 
 void Client::display_menu()
@@ -65,6 +34,7 @@ void Client::display_menu()
 
 void Client::handle_menu_input(Facility &facility)
 {
+  shared_ptr<Client> self = static_pointer_cast<Client>(shared_from_this());
   int option;
   while (true)
   {
@@ -77,13 +47,14 @@ void Client::handle_menu_input(Facility &facility)
       facility.display_schedule();
       break;
     case 2:
-      facility.request_event(make_shared<Client>(*this));
+      facility.request_event(self);
       break;
     case 3:
+      facility.load_event_history();
       display_my_events();
       break;
     case 4:
-      facility.cancel_event(make_shared<Client>(*this));
+      facility.cancel_event(self);
       break;
     case 5:
       User::claim_balance();
@@ -97,6 +68,7 @@ void Client::handle_menu_input(Facility &facility)
       cout << "Invalid option. Please try again." << endl;
       continue; // Skip the rest of the loop and redisplay the menu
     }
+    facility.commit_journal();
 
     while (true)
     {
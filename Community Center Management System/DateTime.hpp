@@ -2,49 +2,95 @@
 
 #include <iostream>
 #include <string>
-#include <chrono>
-#include <sstream>
-#include <iomanip>
-#include <ctime>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
 
 using namespace std;
 
 /**
- * A wrapper class for C++ chrono library for DateTime functionality specfic to this management app.
+ * A point in wall clock time, to the minute, with DateTime functionality specific to this management
+ * app. It is stored as a single count of minutes since 01/01/1970 00:00, read as if it were UTC, so it is
+ * trivially copyable, compares as one integer and does not depend on the time zone. The date and time
+ * strings are only formatted when asked for.
  */
 class DateTime
 {
+public:
+  static constexpr long long INVALID_DAY = INT64_MIN; // the day parse_dates gives a date that is not valid
+
 private:
-  chrono::system_clock::time_point dateTime;
-  string date;
-  string time;
+  int64_t minutes; // since 01/01/1970 00:00
+
+  // What an unparseable date or time gives, 12/31/1899 00:00, as the zeroed struct tm it used to come from did
+  static constexpr int64_t INVALID_MINUTES = -25568LL * 1440;
 
-  tm parse_date_time(const string &date, const string &time) const
+  static uint64_t load8(const char *bytes)
+  {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+  }
+  /**
+   * Checks the first 8 bytes of a date, "MM/DD/YY", a word at a time: each digit byte XOR '0' must be
+   * below 10, and each '/' byte XOR '/' must be 0. The masks are loaded from byte strings, so they line up
+   * with the date's bytes whatever the byte order.
+   */
+  static bool is_date_prefix(const char *date)
+  {
+    static const uint64_t EXPECTED = load8("00/00/00");
+    static const uint64_t HIGH_NIBBLES = load8("\xF0\xF0\xFF\xF0\xF0\xFF\xF0\xF0"); // and the whole '/' bytes
+    static const uint64_t SIXES = load8("\x06\x06\x00\x06\x06\x00\x06\x06");
+    static const uint64_t TENS = load8("\x10\x10\x00\x10\x10\x00\x10\x10");
+    uint64_t offsets = load8(date) ^ EXPECTED;
+    // With every high nibble clear, adding 6 reaches bit 4 of a byte only if the digit was over 9, and never carries
+    return (offsets & HIGH_NIBBLES) == 0 && ((offsets + SIXES) & TENS) == 0;
+  }
+  static bool is_digit(char c) { return static_cast<unsigned char>(c - '0') < 10; }
+  static int two_digits(const char *digits) { return (digits[0] - '0') * 10 + (digits[1] - '0'); }
+  static bool is_leap_year(long long year) { return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0); }
+  static int days_in_month(long long year, int month)
   {
-    tm tm = {};
-    stringstream ss(date + " " + time);
-    ss >> get_time(&tm, "%m/%d/%Y %H:%M");
-    return tm;
+    static const int DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return DAYS[month - 1] + (month == 2 && is_leap_year(year));
   }
-  tm to_tm(const chrono::system_clock::time_point &tp) const
+  static bool is_well_formed_date(string_view date)
   {
-    time_t time = chrono::system_clock::to_time_t(tp);
-    tm tm = *localtime(&time);
-    return tm;
+    return date.size() == 10 && is_date_prefix(date.data()) & is_digit(date[8]) & is_digit(date[9]);
+  }
+  // Converts a well formed date, checking that its month and day exist
+  static bool convert_date(const char *date, long long &days)
+  {
+    int month = two_digits(&date[0]);
+    int day = two_digits(&date[3]);
+    long long year = two_digits(&date[6]) * 100 + two_digits(&date[8]);
+    if (month < 1 || month > 12 || day < 1 || day > days_in_month(year, month))
+      return false;
+    days = days_from_civil(year, month, day);
+    return true;
   }
 
 public:
   /**
-   * A constructor for a DateTime object.
+   * A constructor for a DateTime object. A date or time not in the given format gives 12/31/1899 00:00.
    *
    * @param date the date in MM/DD/YYYY format
    * @param time the time in HH:MM format
    */
-  DateTime(const string &date, const string &time) : date(date), time(time)
+  DateTime(string_view date, string_view time)
   {
-    tm tm = parse_date_time(date, time);
-    dateTime = chrono::system_clock::from_time_t(mktime(&tm));
+    long long days;
+    int minute_of_day;
+    minutes = parse_date(date, days) && parse_time(time, minute_of_day) ? days * 1440 + minute_of_day : INVALID_MINUTES;
   }
+  /**
+   * A constructor for a DateTime object.
+   *
+   * @param minutes_since_epoch the minutes since 01/01/1970 00:00, as returned by minutes_since_epoch
+   */
+  constexpr explicit DateTime(int64_t minutes_since_epoch) : minutes(minutes_since_epoch) {}
   ~DateTime() = default;
 
   /**
@@ -52,13 +98,153 @@ public:
    *
    * @return the date in MM/DD/YYYY format
    */
-  string get_date_str() const { return date; }
+  string get_date_str() const { return day_number_to_date_str(get_day_number()); }
   /**
    * Returns the time string of this DateTime.
    *
    * @return the time in HH:MM format
    */
-  string get_time_str() const { return time; }
+  string get_time_str() const
+  {
+    int64_t minute_of_day = minutes - get_day_number() * 1440;
+    char time[8];
+    snprintf(time, sizeof(time), "%02d:%02d", static_cast<int>(minute_of_day / 60), static_cast<int>(minute_of_day % 60));
+    return time;
+  }
+  /**
+   * Returns this DateTime as a number of minutes, for use as a compact key.
+   *
+   * @return the minutes since the epoch
+   */
+  constexpr long long minutes_since_epoch() const { return minutes; }
+  /**
+   * Returns the date of this DateTime as a number of days, for use as a compact key.
+   *
+   * @return the days since 01/01/1970
+   */
+  constexpr long long get_day_number() const { return minutes >= 0 ? minutes / 1440 : (minutes - 1439) / 1440; }
+  /**
+   * Returns the hour of this DateTime.
+   *
+   * @return the hour, from 0 to 23
+   */
+  constexpr int get_hour() const { return static_cast<int>((minutes - get_day_number() * 1440) / 60); }
+  /**
+   * Returns the start of an hour on the same day as this DateTime.
+   *
+   * @param hour the hour, from 0 to 23
+   * @return the DateTime at hour:00 on this day
+   */
+  constexpr DateTime at_hour(int hour) const { return DateTime(get_day_number() * 1440 + hour * 60); }
+
+  // Util functions on calendar days
+  /**
+   * Parses a date without allocating or calling into the C library.
+   *
+   * @param date the date in MM/DD/YYYY format
+   * @param days the output days since 01/01/1970, set only if the date is valid
+   * @return is the date valid
+   */
+  static bool parse_date(string_view date, long long &days)
+  {
+    return is_well_formed_date(date) && convert_date(date.data(), days);
+  }
+  /**
+   * Parses a time without allocating or calling into the C library.
+   *
+   * @param time the time in HH:MM format
+   * @param minute_of_day the output minutes since midnight, set only if the time is valid
+   * @return is the time valid
+   */
+  static bool parse_time(string_view time, int &minute_of_day)
+  {
+    if (time.size() != 5 || !is_digit(time[0]) || !is_digit(time[1]) || time[2] != ':' || !is_digit(time[3]) ||
+        !is_digit(time[4]))
+      return false;
+    int hour = two_digits(&time[0]);
+    int minute = two_digits(&time[3]);
+    if (hour > 23 || minute > 59)
+      return false;
+    minute_of_day = hour * 60 + minute;
+    return true;
+  }
+  /**
+   * Parses a column of dates, such as the date column of a CSV file, checking the format of all of them
+   * before converting any.
+   *
+   * @param dates the dates in MM/DD/YYYY format
+   * @param days the output days since 01/01/1970 of each date, in the same order, or INVALID_DAY for a date
+   *             that is not valid
+   * @return the number of valid dates
+   */
+  static size_t parse_dates(const vector<string_view> &dates, vector<long long> &days)
+  {
+    // The format checks are a word compare per date, so a first pass over the column finds the malformed
+    // dates without branching on the data, and the second only converts the well formed ones
+    vector<uint8_t> well_formed(dates.size());
+    for (size_t i = 0; i < dates.size(); i++)
+      well_formed[i] = is_well_formed_date(dates[i]);
+
+    days.assign(dates.size(), INVALID_DAY);
+    size_t valid = 0;
+    for (size_t i = 0; i < dates.size(); i++)
+    {
+      if (well_formed[i] && convert_date(dates[i].data(), days[i]))
+        valid++;
+    }
+    return valid;
+  }
+  /**
+   * Returns the number of a calendar day in the proleptic Gregorian calendar.
+   *
+   * @param year the year
+   * @param month the month, from 1 to 12
+   * @param day the day of the month, from 1
+   * @return the days since 01/01/1970
+   */
+  static constexpr long long days_from_civil(long long year, int month, int day)
+  {
+    year -= month <= 2;
+    long long era = (year >= 0 ? year : year - 399) / 400;
+    long long year_of_era = year - era * 400;
+    long long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+  }
+  /**
+   * Returns the calendar day with the given number, the inverse of days_from_civil.
+   *
+   * @param days the days since 01/01/1970
+   * @param year the output year
+   * @param month the output month, from 1 to 12
+   * @param day the output day of the month, from 1
+   */
+  static constexpr void civil_from_days(long long days, int &year, int &month, int &day)
+  {
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    long long day_of_era = days - era * 146097;
+    long long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    long long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    long long shifted_month = (5 * day_of_year + 2) / 153;
+    day = static_cast<int>(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+    month = static_cast<int>(shifted_month < 10 ? shifted_month + 3 : shifted_month - 9);
+    year = static_cast<int>(year_of_era + era * 400 + (month <= 2));
+  }
+  /**
+   * Returns the date string of a calendar day.
+   *
+   * @param days the days since 01/01/1970
+   * @return the date in MM/DD/YYYY format
+   */
+  static string day_number_to_date_str(long long days)
+  {
+    int year = 0, month = 0, day = 0;
+    civil_from_days(days, year, month, day);
+    char date[16];
+    snprintf(date, sizeof(date), "%02d/%02d/%04d", month, day, year);
+    return date;
+  }
 
   // Util functions on DateTime
   /**
@@ -67,64 +253,55 @@ public:
    * @param other the other DateTime
    * @return the hours difference between the two DateTime objects
    */
-  int hours_difference(const DateTime &other) const
+  constexpr int hours_difference(const DateTime &other) const
   {
-    auto duration = chrono::duration_cast<chrono::hours>(dateTime - other.dateTime);
-    return static_cast<int>(duration.count());
+    return static_cast<int>((minutes - other.minutes) / 60);
   }
   /**
    * Returns the number of hours until the Facility closes (23:00).
    *
    * @return the number of hours until the Facility closes
    */
-  int hours_until_facility_close() const
-  {
-    tm this_tm = to_tm(dateTime);
-    return 23 - this_tm.tm_hour;
-  }
+  constexpr int hours_until_facility_close() const { return 23 - get_hour(); }
   /**
    * Is this DateTime on the same day or after the other DateTime?
    *
    * @param other the other DateTime
    * @return is this DateTime on the same day or after the other DateTime
    */
-  bool is_same_day_or_after(const DateTime &other) const
+  constexpr bool is_same_day_or_after(const DateTime &other) const
   {
-    tm this_tm = to_tm(dateTime);
-    tm other_tm = to_tm(other.dateTime);
-    // Compare years, months, and days only
-    if (this_tm.tm_year > other_tm.tm_year)
-      return true;
-    if (this_tm.tm_year == other_tm.tm_year && this_tm.tm_mon > other_tm.tm_mon)
-      return true;
-    if (this_tm.tm_year == other_tm.tm_year && this_tm.tm_mon == other_tm.tm_mon && this_tm.tm_mday >= other_tm.tm_mday)
-      return true;
-    return false;
+    return get_day_number() >= other.get_day_number();
   }
 
   // Overload comparison operators for DateTime
-  bool operator==(const DateTime &other) const
+  constexpr bool operator==(const DateTime &other) const
   {
-    return dateTime == other.dateTime;
+    return minutes == other.minutes;
   }
-  bool operator!=(const DateTime &other) const
+  constexpr bool operator!=(const DateTime &other) const
   {
     return !(*this == other);
   }
-  bool operator<(const DateTime &other) const
+  constexpr bool operator<(const DateTime &other) const
   {
-    return dateTime < other.dateTime;
+    return minutes < other.minutes;
   }
-  bool operator<=(const DateTime &other) const
+  constexpr bool operator<=(const DateTime &other) const
   {
-    return dateTime <= other.dateTime;
+    return minutes <= other.minutes;
   }
-  bool operator>(const DateTime &other) const
+  constexpr bool operator>(const DateTime &other) const
   {
-    return dateTime > other.dateTime;
+    return minutes > other.minutes;
   }
-  bool operator>=(const DateTime &other) const
+  constexpr bool operator>=(const DateTime &other) const
   {
-    return dateTime >= other.dateTime;
+    return minutes >= other.minutes;
   }
 };
+
+static_assert(DateTime::days_from_civil(1970, 1, 1) == 0 && DateTime::days_from_civil(2024, 2, 29) == 19782,
+              "days_from_civil must count days since 01/01/1970");
+static_assert(DateTime(-1).get_day_number() == -1 && DateTime(-1).get_hour() == 23,
+              "get_day_number and get_hour must round down before the epoch");
@@ -1,13 +1,12 @@
 #include "Event.hpp"
 #include "Payment.hpp"
-#include <algorithm>
 
 Event::Event(const DateTime &dt, const LayoutType &layout, const GuestType &guest_type, const bool &is_public,
              const int &price_per_ticket, const int &duration_in_hours, const int &capacity, const Payment &payment, const shared_ptr<User> &organizer)
     : dt(dt), layout(layout), guest_type(guest_type), is_public(is_public), price_per_ticket(price_per_ticket),
       duration_in_hours(duration_in_hours), capacity(capacity), payment(payment), organizer(organizer) {}
 
-DateTime Event::get_dt() const { return dt; }
+const DateTime &Event::get_dt() const { return dt; }
 
 string Event::get_date() const { return dt.get_date_str(); }
 
@@ -15,7 +14,7 @@ string Event::get_time() const { return dt.get_time_str(); }
 
 Event::LayoutType Event::get_layout() const { return layout; }
 
-shared_ptr<User> Event::get_organizer() const { return organizer; }
+const shared_ptr<User> &Event::get_organizer() const { return organizer; }
 
 int Event::get_duration() const { return duration_in_hours; }
 
@@ -27,25 +26,52 @@ Event::GuestType Event::get_guest_type() const { return guest_type; }
 
 bool Event::get_is_public() const { return is_public; }
 
-Payment Event::get_payment() const { return payment; }
+const Payment &Event::get_payment() const { return payment; }
 
-vector<Ticket> Event::get_tickets() const { return tickets; }
+const TicketHolders &Event::get_tickets() const { return tickets; }
 
-queue<shared_ptr<Citizen>> Event::get_waitlist() const { return waitlist; }
+const Ticket *Event::find_ticket(const shared_ptr<Citizen> &citizen) const { return tickets.find(citizen.get()); }
+
+const Waitlist &Event::get_waitlist() const { return waitlist; }
+
+size_t Event::waitlist_position(const shared_ptr<Citizen> &citizen) const { return waitlist.position(citizen.get()); }
 
 void Event::remove_ticket(const Ticket &ticket)
 {
-  tickets.erase(remove(tickets.begin(), tickets.end(), ticket), tickets.end());
+  if (tickets.erase(ticket.get_holder().get()))
+    touch();
+}
+
+bool Event::add_to_waitlist(const shared_ptr<Citizen> &citizen)
+{
+  if (!waitlist.push(citizen))
+    return false;
+  touch();
+  return true;
+}
+
+bool Event::remove_from_waitlist(const shared_ptr<Citizen> &citizen)
+{
+  if (!waitlist.erase(citizen.get()))
+    return false;
+  touch();
+  return true;
 }
 
-void Event::add_to_waitlist(const shared_ptr<Citizen> &citizen)
+shared_ptr<Citizen> Event::pop_waitlist()
 {
-  waitlist.push(citizen);
+  shared_ptr<Citizen> citizen = waitlist.pop();
+  if (citizen)
+    touch();
+  return citizen;
 }
 
-void Event::add_ticket(const Ticket &ticket)
+bool Event::add_ticket(const Ticket &ticket)
 {
-  tickets.push_back(ticket);
+  if (!tickets.insert(ticket))
+    return false;
+  touch();
+  return true;
 }
 
 bool Event::operator==(const Event &other) const
@@ -64,11 +90,11 @@ ostream &operator<<(ostream &out, const Event &e)
       << e.duration_in_hours << " hours, with layout " << layout_type << ", price per ticket: $" << e.price_per_ticket << endl;
   out << "- Organizer: " << e.organizer->get_username() << endl;
   out << "- Attendees: ";
-  for (size_t i = 0; i < e.tickets.size(); i++)
+  for (auto it = e.tickets.begin(); it != e.tickets.end(); ++it)
   {
-    out << e.tickets[i].get_holder_username();
-    if (i < e.tickets.size() - 1)
+    if (it != e.tickets.begin())
       out << ", ";
+    out << it->get_holder_username();
   }
   return out;
 }
@@ -4,18 +4,21 @@
 #include "Citizen.hpp"
 #include "Client.hpp"
 #include "Ticket.hpp"
+#include "TicketHolders.hpp"
+#include "Waitlist.hpp"
 #include "Payment.hpp"
 #include "DateTime.hpp"
+#include "Versioned.hpp"
+#include <map>
 #include <memory>
 #include <vector>
-#include <queue>
 
 // Forward declarations
 class User;
 class Citizen;
 class Ticket;
 
-class Event
+class Event : public Versioned
 {
 public:
   enum LayoutType
@@ -32,6 +35,12 @@ public:
     NONRESIDENTS,
     BOTH
   };
+
+  /**
+   * The capacity of an Event when none is given, as for events saved before capacities were.
+   */
+  static constexpr int DEFAULT_CAPACITY = 40;
+
   Event(const DateTime &dt, const LayoutType &layout, const GuestType &guest_type, const bool &is_public,
         const int &price_per_ticket, const int &duration_in_hours, const int &capacity, const Payment &payment, const shared_ptr<User> &organizer);
 
@@ -41,7 +50,7 @@ public:
    *
    * @return the DateTime
    */
-  DateTime get_dt() const;
+  const DateTime &get_dt() const;
   /**
    * Gets the date of this Event.
    *
@@ -65,7 +74,7 @@ public:
    *
    * @return the organizer of this Event
    */
-  shared_ptr<User> get_organizer() const;
+  const shared_ptr<User> &get_organizer() const;
   /**
    * Gets the duration of this Event.
    *
@@ -77,13 +86,27 @@ public:
    */
   int get_price_per_ticket() const;
   /**
-   * Gets the tickets of this Event.
+   * Gets the tickets of this Event, in purchase order.
+   */
+  const TicketHolders &get_tickets() const;
+  /**
+   * Finds the ticket a Citizen holds for this Event.
+   *
+   * @param citizen the Citizen
+   * @return the Ticket, or nullptr if the Citizen holds none
    */
-  vector<Ticket> get_tickets() const;
+  const Ticket *find_ticket(const shared_ptr<Citizen> &citizen) const;
   /**
-   * Gets the waitlist of this Event.
+   * Gets the waitlist of this Event, from the first Citizen in line to the last.
+   */
+  const Waitlist &get_waitlist() const;
+  /**
+   * Gets a Citizen's place on the waitlist of this Event.
+   *
+   * @param citizen the Citizen
+   * @return 1 for the front of the line, or 0 if the Citizen is not waiting
    */
-  queue<shared_ptr<Citizen>> get_waitlist() const;
+  size_t waitlist_position(const shared_ptr<Citizen> &citizen) const;
   /**
    * Gets the capacity of this Event.
    */
@@ -103,19 +126,35 @@ public:
    *
    * @return the Payment
    */
-  Payment get_payment() const;
+  const Payment &get_payment() const;
   /**
-   * Remove a ticket from the event.
+   * Remove a ticket from the event, matched by its holder.
    */
   void remove_ticket(const Ticket &ticket);
   /**
-   * Adds the citizen to the waitlist.
+   * Adds the citizen to the back of the waitlist, unless they are already on it.
+   *
+   * @return was the citizen added
    */
-  void add_to_waitlist(const shared_ptr<Citizen> &citizen);
+  bool add_to_waitlist(const shared_ptr<Citizen> &citizen);
   /**
-   * Adds a ticket to the event.
+   * Removes a Citizen from wherever they are on the waitlist.
+   *
+   * @return was the Citizen on the waitlist
+   */
+  bool remove_from_waitlist(const shared_ptr<Citizen> &citizen);
+  /**
+   * Removes the first Citizen from the waitlist.
+   *
+   * @return the Citizen, or nullptr if the waitlist is empty
    */
-  void add_ticket(const Ticket &ticket);
+  shared_ptr<Citizen> pop_waitlist();
+  /**
+   * Adds a ticket to the event, unless its holder already holds one.
+   *
+   * @return was the ticket added
+   */
+  bool add_ticket(const Ticket &ticket);
 
   /**
    * Operator overload for Event ==.
@@ -153,6 +192,11 @@ private:
   // event objects
   Payment payment;
   shared_ptr<User> organizer;
-  vector<Ticket> tickets;
-  queue<shared_ptr<Citizen>> waitlist;
-};
\ No newline at end of file
+  TicketHolders tickets;
+  Waitlist waitlist;
+};
+
+/**
+ * Confirmed Events by start minute, in time order. Events sharing a start keep the order they were added in.
+ */
+using Schedule = multimap<long long, shared_ptr<Event>>;
\ No newline at end of file
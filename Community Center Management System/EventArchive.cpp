@@ -0,0 +1,204 @@
+#include "EventArchive.hpp"
+#include "fileio.hpp"
+#include "history.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+  const string CUTOFF_PREFIX = "ARCHIVED_BEFORE,";
+  const size_t DATE_WIDTH = 10; // MM/DD/YYYY
+  const off_t HEADER_SIZE = CUTOFF_PREFIX.size() + DATE_WIDTH + 1;
+
+  DateTime start_of_day(const string &date)
+  {
+    return DateTime(date, "00:00");
+  }
+
+  bool write_all(int fd, const string &content, off_t offset)
+  {
+    const char *data = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0)
+    {
+      ssize_t written = pwrite(fd, data, remaining, offset);
+      if (written < 0)
+        return false;
+      data += written;
+      remaining -= written;
+      offset += written;
+    }
+    return true;
+  }
+}
+
+EventArchive::EventArchive(const string &file_path, const UserDirectory &users)
+    : file_path(file_path), users(users), loaded(true), needs_rewrite(false)
+{
+  ifstream infile(file_path);
+  string first_line;
+  if (infile.is_open() && getline(infile, first_line) && first_line.rfind(CUTOFF_PREFIX, 0) == 0)
+  {
+    // The cutoff is blank if the first archiving stopped before it was written
+    cutoff_date = first_line.substr(CUTOFF_PREFIX.size(), DATE_WIDTH);
+    if (cutoff_date.find(' ') != string::npos)
+      cutoff_date.clear();
+    loaded = false;
+  }
+}
+
+bool EventArchive::is_archived(const Event &event) const
+{
+  return !cutoff_date.empty() && event.get_dt() < start_of_day(cutoff_date);
+}
+
+bool EventArchive::is_ahead_of(const DateTime &dt) const
+{
+  return !cutoff_date.empty() && start_of_day(dt.get_date_str()) < start_of_day(cutoff_date);
+}
+
+void EventArchive::archive(vector<shared_ptr<Event>> &past_events, const DateTime &cutoff)
+{
+  // Events before the old cutoff are already in the file, if the last run stopped before saving
+  vector<const Event *> new_events;
+  for (const shared_ptr<Event> &event : past_events)
+  {
+    if (!is_archived(*event))
+      new_events.push_back(event.get());
+  }
+
+  bool moves_cutoff = cutoff_date.empty() || start_of_day(cutoff_date) < start_of_day(cutoff.get_date_str());
+  if (moves_cutoff || !new_events.empty())
+  {
+    int fd = open(file_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+      cout << "Error write to file: " << file_path << endl;
+      return;
+    }
+
+    // The blocks are made durable before the cutoff that covers them is written, so a crash in between
+    // only leaves Events that get archived again, which load() skips. A block torn by a crash is cut off.
+    off_t end = lseek(fd, 0, SEEK_END);
+    bool ok = end >= 0;
+    if (ok && end < HEADER_SIZE)
+    {
+      ok = write_cutoff(fd);
+      end = HEADER_SIZE;
+    }
+    else if (ok)
+      end = history::valid_length(fd, HEADER_SIZE, end);
+    string blocks = history::encode(new_events);
+    ok = ok && write_all(fd, blocks, end) && ftruncate(fd, end + blocks.size()) == 0 && fdatasync(fd) == 0;
+    if (ok && moves_cutoff)
+    {
+      cutoff_date = cutoff.get_date_str();
+      ok = write_cutoff(fd) && fdatasync(fd) == 0;
+    }
+    close(fd);
+    if (!ok)
+    {
+      cout << "Error write to file: " << file_path << endl;
+      return;
+    }
+  }
+
+  for (shared_ptr<Event> &event : past_events)
+  {
+    if (registered.insert(event->get_dt().minutes_since_epoch()).second)
+      events.push_back(move(event));
+  }
+  past_events.clear();
+}
+
+vector<shared_ptr<Event>> EventArchive::restore(const DateTime &cutoff)
+{
+  load();
+  auto restored_begin = stable_partition(events.begin(), events.end(), [&cutoff](const shared_ptr<Event> &event)
+                                         { return event->get_dt() < start_of_day(cutoff.get_date_str()); });
+  vector<shared_ptr<Event>> restored(make_move_iterator(restored_begin), make_move_iterator(events.end()));
+  events.erase(restored_begin, events.end());
+
+  cutoff_date = cutoff.get_date_str();
+  needs_rewrite = true;
+  return restored;
+}
+
+void EventArchive::load()
+{
+  if (loaded)
+    return;
+
+  history::for_each_event(file_path, HEADER_SIZE, users, [this](const shared_ptr<Event> &event)
+                          {
+    // Skip Events that were archived during this run, and so are registered already, and repeated ones
+    if (registered.insert(event->get_dt().minutes_since_epoch()).second)
+    {
+      event_utils::register_confirmed_event(event);
+      events.push_back(event);
+    }
+    return true; });
+  loaded = true;
+}
+
+const vector<shared_ptr<Event>> &EventArchive::get_events() const { return events; }
+
+void EventArchive::save()
+{
+  if (needs_rewrite && rewrite())
+    needs_rewrite = false;
+}
+
+void EventArchive::import_csv(const string &csv_path)
+{
+  ifstream infile(csv_path);
+  string first_line;
+  if (!infile.is_open() || !getline(infile, first_line) || first_line.rfind(CUTOFF_PREFIX, 0) != 0)
+    return;
+  infile.close();
+
+  load();
+  // The first line of the CSV is its cutoff, which the reader skips like a header
+  event_utils::for_each_confirmed_event(csv_path, users, [this](const shared_ptr<Event> &event)
+                                        {
+    if (registered.insert(event->get_dt().minutes_since_epoch()).second)
+    {
+      event_utils::register_confirmed_event(event);
+      events.push_back(event);
+    }
+    return true; });
+  string csv_cutoff = first_line.substr(CUTOFF_PREFIX.size(), DATE_WIDTH);
+  if (csv_cutoff.size() == DATE_WIDTH && csv_cutoff.find(' ') == string::npos &&
+      (cutoff_date.empty() || start_of_day(cutoff_date) < start_of_day(csv_cutoff)))
+    cutoff_date = csv_cutoff;
+
+  if (rewrite())
+    remove(csv_path.c_str());
+}
+
+string EventArchive::cutoff_line() const
+{
+  // Padded to a fixed width, so that a later cutoff overwrites it exactly
+  string line = CUTOFF_PREFIX + cutoff_date;
+  line.resize(HEADER_SIZE - 1, ' ');
+  return line + '\n';
+}
+
+bool EventArchive::write_cutoff(int fd) const
+{
+  string line = cutoff_line();
+  return pwrite(fd, line.data(), line.size(), 0) == static_cast<ssize_t>(line.size());
+}
+
+bool EventArchive::rewrite() const
+{
+  vector<const Event *> all_events;
+  for (const shared_ptr<Event> &event : events)
+    all_events.push_back(event.get());
+  return fileio::replace_file(file_path, cutoff_line() + history::encode(all_events));
+}
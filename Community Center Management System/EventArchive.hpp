@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Event.hpp"
+#include "DateTime.hpp"
+#include "UserDirectory.hpp"
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+using namespace std;
+
+/**
+ * The cold tier of confirmed Events: every Event on a day before the archive's cutoff. Archived Events
+ * are appended to their own file as soon as they are archived, and are only read back into memory when
+ * a User's history is needed. The file starts with a fixed-width line recording the cutoff day, so that
+ * the cutoff can be moved forward in place, followed by the Events in the compact history encoding.
+ */
+class EventArchive
+{
+public:
+  /**
+   * Opens an archive file, reading only its cutoff.
+   *
+   * @param file_path the archive file path
+   * @param users the Users that archived Events are resolved against
+   */
+  EventArchive(const string &file_path, const UserDirectory &users);
+
+  /**
+   * Is the archive's cutoff after the given day, so that some archived Events are not past anymore?
+   *
+   * @param dt a DateTime on the day
+   * @return is the cutoff after the day
+   */
+  bool is_ahead_of(const DateTime &dt) const;
+
+  /**
+   * Archives Events and moves the cutoff forward to the given day. Every Event before that day must be
+   * either passed in or already archived. The Events must already be registered with their Users.
+   *
+   * @param past_events the handles of the Events to archive, which are moved into the archive
+   * @param cutoff a DateTime on the new cutoff day
+   */
+  void archive(vector<shared_ptr<Event>> &past_events, const DateTime &cutoff);
+  /**
+   * Removes the archived Events on or after the given day and moves the cutoff back to it. The file
+   * is rewritten on the next save, so the Events stay archived on disk until the caller has saved them.
+   *
+   * @param cutoff a DateTime on the new cutoff day
+   * @return the handles of the Events removed from the archive
+   */
+  vector<shared_ptr<Event>> restore(const DateTime &cutoff);
+
+  /**
+   * Reads the archived Events into memory and registers them with their Users, if not done already.
+   */
+  void load();
+  /**
+   * Gets the archived Events that are in memory.
+   *
+   * @return the Events, which are only complete after load()
+   */
+  const vector<shared_ptr<Event>> &get_events() const;
+
+  /**
+   * Rewrites the archive file if Events were restored since it was written.
+   */
+  void save();
+
+  /**
+   * Moves the Events of an archive that was saved as CSV by an earlier version into this archive,
+   * and removes the CSV once they are saved. Does nothing if the CSV doesn't exist.
+   *
+   * @param csv_path the CSV archive file path
+   */
+  void import_csv(const string &csv_path);
+
+private:
+  string file_path;
+  const UserDirectory &users;
+  string cutoff_date; // empty while nothing is archived
+  vector<shared_ptr<Event>> events;
+  unordered_set<long long> registered; // Events in memory that were registered before being archived
+  bool loaded;
+  bool needs_rewrite;
+
+  bool is_archived(const Event &event) const;
+
+  string cutoff_line() const;
+  bool write_cutoff(int fd) const;
+  bool rewrite() const;
+};
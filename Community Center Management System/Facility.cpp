@@ -1,63 +1,398 @@
 #include "Facility.hpp"
 #include "DateTime.hpp"
+#include "Journal.hpp"
+#include "fileio.hpp"
 #include "prompt.hpp"
+#include "pricing.hpp"
 #include <algorithm>
 #include <limits>
 #include <vector>
 
 using namespace std;
 
-Facility::Facility(shared_ptr<User> manager, const DateTime &dt) : manager(manager), mock_dt(dt) {}
+namespace
+{
+  const int OPENING_HOUR = 8;
+  const int CLOSING_HOUR = 23;
+
+  // The occupancy bits of the hours from begin_hour up to end_hour, clipped to the opening hours
+  uint16_t hour_bits(int begin_hour, int end_hour)
+  {
+    int begin = max(begin_hour, OPENING_HOUR) - OPENING_HOUR;
+    int end = min(end_hour, CLOSING_HOUR) - OPENING_HOUR;
+    return begin >= end ? 0 : static_cast<uint16_t>((1u << end) - (1u << begin));
+  }
+
+  const uint16_t OPEN_HOURS = hour_bits(OPENING_HOUR, CLOSING_HOUR);
+
+  string hour_to_time_str(int hour)
+  {
+    return (hour < 10 ? "0" : "") + to_string(hour) + ":00";
+  }
+
+  pair<long long, long long> booked_minutes(const DateTime &start, int duration)
+  {
+    long long begin = start.minutes_since_epoch();
+    return {begin, begin + duration * 60LL};
+  }
+
+  pair<long long, long long> booked_minutes(const Event &event)
+  {
+    return booked_minutes(event.get_dt(), event.get_duration());
+  }
+
+  // The schedule key of midnight on the day of dt
+  long long day_start_minutes(const DateTime &dt)
+  {
+    return dt.at_hour(0).minutes_since_epoch();
+  }
+}
 
-vector<Event> Facility::get_confirmed_events() const { return confirmed_events; }
+void Facility::book(const Event &event)
+{
+  pair<long long, long long> minutes = booked_minutes(event);
+  booked_times.insert(minutes.first, minutes.second);
 
-vector<ReservationRequest> Facility::get_pending_events() const { return pending_events; }
+  DateTime dt = event.get_dt();
+  uint16_t hours = hour_bits(dt.get_hour(), dt.get_hour() + event.get_duration());
+  if (hours != 0)
+    occupancy[dt.get_day_number()] |= hours;
+}
+
+void Facility::unbook(const Event &event)
+{
+  pair<long long, long long> minutes = booked_minutes(event);
+  booked_times.erase(minutes.first, minutes.second);
+
+  // Events booked before overlaps were refused may share hours with this one, so the day's hours are
+  // rebuilt from the events left on it
+  long long opening = event.get_dt().at_hour(OPENING_HOUR).minutes_since_epoch();
+  uint16_t hours = 0;
+  for (const pair<long long, long long> &interval : booked_times.overlapping(opening, opening + (CLOSING_HOUR - OPENING_HOUR) * 60))
+  {
+    int begin_hour = interval.first < opening ? 0 : OPENING_HOUR + (interval.first - opening) / 60;
+    hours |= hour_bits(begin_hour, OPENING_HOUR + (interval.second - opening + 59) / 60);
+  }
+  if (hours != 0)
+    occupancy[event.get_dt().get_day_number()] = hours;
+  else
+    occupancy.erase(event.get_dt().get_day_number());
+}
 
-void Facility::add_confirmed_event(const Event &event)
+void Facility::schedule(shared_ptr<Event> event)
 {
-  confirmed_events.push_back(event);
+  book(*event);
+  long long start = event->get_dt().minutes_since_epoch();
+  // Events sharing a start are kept in the order they were added, and event_slots keeps the first
+  Schedule::iterator position = confirmed_events.emplace_hint(confirmed_events.end(), start, move(event));
+  event_slots.emplace(start, position);
+}
+
+Schedule::iterator Facility::unschedule(Schedule::iterator position)
+{
+  unbook(*position->second);
+  long long start = position->first;
+  auto slot = event_slots.find(start);
+  Schedule::iterator next = confirmed_events.erase(position);
+  if (slot->second != position)
+    return next;
+  if (next != confirmed_events.end() && next->first == start)
+    slot->second = next;
+  else
+    event_slots.erase(slot);
+  return next;
+}
+
+Facility::Facility(shared_ptr<User> manager, const DateTime &dt)
+    : manager(manager), mock_dt(dt), journal(nullptr), archive(nullptr) {}
+
+const Schedule &Facility::get_confirmed_events() const { return confirmed_events; }
+
+const PendingRequests &Facility::get_pending_events() const { return pending_events; }
+
+void Facility::add_confirmed_event(const shared_ptr<Event> &event)
+{
+  schedule(event);
 }
 
 void Facility::remove_confirmed_event(const Event &event)
 {
-  confirmed_events.erase(remove(confirmed_events.begin(), confirmed_events.end(), event), confirmed_events.end());
+  // The matches are found before any is removed, as event may be one of them
+  vector<Schedule::iterator> matches;
+  auto range = confirmed_events.equal_range(event.get_dt().minutes_since_epoch());
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (*it->second == event)
+      matches.push_back(it);
+  }
+  for (Schedule::iterator match : matches)
+    unschedule(match);
 }
 
 void Facility::add_pending_event(const ReservationRequest &event)
 {
-  pending_events.push_back(event);
+  pending_events.insert(event);
 }
 
-void Facility::remove_pending_event(const ReservationRequest &event)
+void Facility::remove_pending_event(PendingRequests::Id id)
 {
-  pending_events.erase(remove(pending_events.begin(), pending_events.end(), event), pending_events.end());
+  pending_events.erase(id);
 }
 
-double Facility::calculate_event_cost(const shared_ptr<User> &requester, const int &duration) const
+shared_ptr<Event> Facility::find_confirmed_event(const DateTime &dt) const
 {
-  if (dynamic_pointer_cast<Citizen>(requester))
+  auto slot = event_slots.find(dt.minutes_since_epoch());
+  return slot == event_slots.end() ? nullptr : slot->second->second;
+}
+
+const ReservationRequest *Facility::find_pending_event(const DateTime &dt) const
+{
+  return pending_events.get(pending_events.find(dt));
+}
+
+bool Facility::is_booked(const DateTime &start, const int &duration) const
+{
+  pair<long long, long long> window = booked_minutes(start, duration);
+  return booked_times.overlaps(window.first, window.second);
+}
+
+vector<const Event *> Facility::events_overlapping(const DateTime &start, const int &duration) const
+{
+  pair<long long, long long> window = booked_minutes(start, duration);
+  vector<pair<long long, long long>> overlapping = booked_times.overlapping(window.first, window.second);
+  vector<const Event *> events;
+  if (overlapping.empty())
+    return events;
+
+  // The intervals come ordered by start; a start is shared only by Events booked before overlaps were refused
+  for (const pair<long long, long long> &interval : overlapping)
   {
-    if (dynamic_pointer_cast<Citizen>(requester)->get_resident_status() == Citizen::ResidentStatus::RESIDENT)
-    {
-      return 10 + (duration * 10);
-    }
-    else if (dynamic_pointer_cast<Citizen>(requester)->get_resident_status() == Citizen::ResidentStatus::NONRESIDENT)
-    {
-      return 10 + (duration * 15);
-    }
+    auto slot = event_slots.find(interval.first);
+    const Event *event = slot == event_slots.end() ? nullptr : slot->second->second.get();
+    if (event != nullptr && (events.empty() || events.back() != event))
+      events.push_back(event);
   }
-  else if (dynamic_pointer_cast<Client>(requester))
+  return events;
+}
+
+vector<const Event *> Facility::schedule_range(const DateTime &from, const DateTime &to) const
+{
+  vector<const Event *> events;
+  auto end = confirmed_events.lower_bound(to.minutes_since_epoch());
+  for (auto it = confirmed_events.lower_bound(from.minutes_since_epoch()); it != end; ++it)
+    events.push_back(it->second.get());
+  return events;
+}
+
+vector<Facility::Slot> Facility::available_slots(const DateTime &first, const DateTime &last, const int &duration) const
+{
+  vector<Slot> slots;
+  if (duration < 1 || duration > CLOSING_HOUR - OPENING_HOUR)
+    return slots;
+
+  long long today = mock_dt.get_day_number();
+  for (long long day = max(first.get_day_number(), today); day <= last.get_day_number(); day++)
   {
-    if (dynamic_pointer_cast<Client>(requester)->get_client_type() == Client::ClientType::CITY)
-    {
-      return 10 + (duration * 5);
-    }
-    else if (dynamic_pointer_cast<Client>(requester)->get_client_type() == Client::ClientType::ORGANIZATION)
+    auto booked = occupancy.find(day);
+    uint16_t starts = OPEN_HOURS & ~(booked == occupancy.end() ? 0 : booked->second);
+    if (day == today)
+      starts &= ~hour_bits(0, mock_dt.get_hour());
+
+    // After this, bit i is set if the hours i to i + length - 1 are all free
+    for (int length = 1; length < duration;)
     {
-      return 10 + (duration * 20);
+      int step = min(length, duration - length);
+      starts &= starts >> step;
+      length += step;
     }
+    for (; starts != 0; starts &= starts - 1)
+      slots.push_back(Slot{day, OPENING_HOUR + __builtin_ctz(starts)});
+  }
+  return slots;
+}
+
+void Facility::attach_journal(Journal *journal)
+{
+  this->journal = journal;
+}
+
+void Facility::commit_journal()
+{
+  if (journal != nullptr)
+    journal->commit();
+}
+
+void Facility::attach_archive(EventArchive *archive)
+{
+  this->archive = archive;
+}
+
+void Facility::archive_past_events()
+{
+  if (archive == nullptr)
+    return;
+
+  if (archive->is_ahead_of(mock_dt))
+  {
+    for (shared_ptr<Event> &event : archive->restore(mock_dt))
+      schedule(move(event));
+  }
+
+  // Past events are exactly the ones the schedule no longer shows, which all start before mock_dt's day
+  auto past_end = confirmed_events.lower_bound(day_start_minutes(mock_dt));
+  vector<shared_ptr<Event>> past_events;
+  for (auto it = confirmed_events.begin(); it != past_end; ++it)
+  {
+    unbook(*it->second);
+    event_slots.erase(it->first);
+    past_events.push_back(move(it->second));
+  }
+  confirmed_events.erase(confirmed_events.begin(), past_end);
+  archive->archive(past_events, mock_dt);
+}
+
+void Facility::load_event_history()
+{
+  if (archive != nullptr)
+    archive->load();
+}
+
+void Facility::save_archive()
+{
+  if (archive != nullptr)
+    archive->save();
+}
+
+void Facility::log(Journal::RecordType type, const string &payload)
+{
+  if (journal != nullptr)
+    journal->append(type, payload);
+}
+
+void Facility::submit_reservation_request(const ReservationRequest &request)
+{
+  // Count the duration of this event against the user's booked hours
+  const shared_ptr<User> &requester = request.get_requester();
+  requester->set_booked_hours(requester->get_booked_hours() + request.get_duration());
+
+  manager->add_to_balance(request.get_payment().get_amount());
+  this->add_pending_event(request);
+  log(Journal::REQUEST, event_utils::pending_event_to_csv(request));
+}
+
+void Facility::approve_reservation_request(PendingRequests::Id id)
+{
+  const ReservationRequest *request = pending_events.get(id);
+  if (request == nullptr)
+    return;
+  ReservationRequest approved = *request; // removing the request from pending_events leaves request dangling
+
+  // Create an Event from the ReservationRequest
+  auto created_event = make_shared<Event>(approved.create_event());
+
+  // Remove the event from the pending Events
+  this->remove_pending_event(id);
+
+  // Confirm the Event in the facility
+  this->add_confirmed_event(created_event);
+
+  // add the event to the user's list of events
+  if (approved.get_requester())
+    approved.get_requester()->add_event(created_event);
+
+  log(Journal::APPROVE, approved.get_date() + "," + approved.get_time());
+}
+
+void Facility::purchase_ticket(Event &event, const shared_ptr<Citizen> &citizen)
+{
+  Ticket new_ticket(citizen, &event);
+  event.add_ticket(new_ticket);
+  citizen->add_ticket(new_ticket);
+  manager->add_to_balance(event.get_price_per_ticket());
+  log(Journal::TICKET, event.get_date() + "," + event.get_time() + "," + citizen->get_username());
+}
+
+bool Facility::add_to_waitlist(Event &event, const shared_ptr<Citizen> &citizen)
+{
+  if (!event.add_to_waitlist(citizen))
+    return false;
+  log(Journal::WAITLIST, event.get_date() + "," + event.get_time() + "," + citizen->get_username());
+  return true;
+}
+
+bool Facility::withdraw_from_waitlist(Event &event, const shared_ptr<Citizen> &citizen)
+{
+  if (!event.remove_from_waitlist(citizen))
+    return false;
+  log(Journal::WITHDRAW, event.get_date() + "," + event.get_time() + "," + citizen->get_username());
+  return true;
+}
+
+void Facility::promote_waitlist(Event &event)
+{
+  // Not journaled: replaying the record that opened the seats promotes the same Citizens again
+  while (event.get_tickets().size() < static_cast<size_t>(event.get_capacity()))
+  {
+    shared_ptr<Citizen> next_citizen = event.pop_waitlist();
+    if (!next_citizen)
+      break;
+    Ticket new_ticket(next_citizen, &event);
+    event.add_ticket(new_ticket);
+    next_citizen->add_ticket(new_ticket);
+    manager->add_to_balance(event.get_price_per_ticket());
+  }
+}
+
+bool Facility::return_ticket(Event &event, const shared_ptr<Citizen> &citizen)
+{
+  const Ticket *held = event.find_ticket(citizen);
+  if (held == nullptr)
+    return false;
+
+  Ticket ticket = *held; // removing the Ticket from the Event leaves held dangling
+  manager->subtract_from_balance(event.get_price_per_ticket());
+  event.remove_ticket(ticket);
+  ticket.refund(event.get_price_per_ticket());
+
+  promote_waitlist(event);
+  log(Journal::REFUND, event.get_date() + "," + event.get_time() + "," + citizen->get_username());
+  return true;
+}
+
+void Facility::cancel_confirmed_event(const shared_ptr<Event> &event, const double &refund)
+{
+  shared_ptr<Event> handle = event; // keeps the Event alive once it is removed from confirmed_events
+  const Event &canceled = *handle;
+
+  // Remove the event from the organizer's booked hours and list of events
+  if (const shared_ptr<User> &organizer = canceled.get_organizer())
+  {
+    organizer->set_booked_hours(organizer->get_booked_hours() - canceled.get_duration());
+    organizer->remove_event(canceled);
+  }
+
+  // Money to be paid
+  manager->subtract_from_balance(refund);
+
+  // Refund the user
+  canceled.get_organizer()->add_to_balance(refund);
+
+  // Refund the tickets
+  for (const Ticket &ticket : canceled.get_tickets())
+  {
+    manager->subtract_from_balance(canceled.get_price_per_ticket());
+    ticket.refund(canceled.get_price_per_ticket());
   }
-  return 0;
+
+  // Remove the event from the confirmed events
+  this->remove_confirmed_event(canceled);
+
+  log(Journal::CANCEL, canceled.get_date() + "," + canceled.get_time() + "," + to_string(refund));
+}
+
+double Facility::calculate_event_cost(const shared_ptr<User> &requester, const int &duration) const
+{
+  return pricing::reservation_cost(requester->get_category(), duration);
 }
 
 void Facility::request_event(shared_ptr<User> requester)
@@ -66,6 +401,7 @@ void Facility::request_event(shared_ptr<User> requester)
   cout << "Event Request:" << endl;
   cout << "Enter the date to be request (MM/DD/YYYY): ";
   string date = prompt::get_user_date_input();
+  display_free_hours(DateTime(date, hour_to_time_str(OPENING_HOUR)));
 
   cout << "Enter the hour of the time for the event (i.e. 8 for 08:00, 22 for 22:00): ";
   string time = prompt::get_user_time_input();
@@ -90,14 +426,13 @@ void Facility::request_event(shared_ptr<User> requester)
   }
 
   // Before creating reservation request, check if the event is available and if the user has overbooked
-  for (const auto &event : confirmed_events)
+  vector<const Event *> overlapping = events_overlapping(dt, duration);
+  if (!overlapping.empty())
   {
-    // logic needs to be changed to check if the requested time is within the duration of the event
-    if (event.get_date() == date && event.get_time() == time)
-    {
-      cout << "Event already booked at that time!" << endl;
-      return;
-    }
+    cout << "Event already booked at that time!" << endl;
+    for (const Event *event : overlapping)
+      cout << *event << endl;
+    return;
   }
   if (requester->has_overbooked(duration))
   {
@@ -105,12 +440,12 @@ void Facility::request_event(shared_ptr<User> requester)
     return;
   }
 
-  // cast the requester to see if its a Citizen or Client
-  if (dynamic_pointer_cast<Citizen>(requester))
+  // Citizens are also offered the wedding layout
+  if (requester->is_citizen())
   {
     cout << "Enter the layout type (1. Meeting, 2. Lecture, 3. Dance, 4. Wedding): ";
   }
-  else if (dynamic_pointer_cast<Client>(requester))
+  else if (requester->is_client())
   {
     cout << "Enter the layout type (1. Meeting, 2. Lecture, 3. Dance): ";
   }
@@ -283,17 +618,10 @@ void Facility::request_event(shared_ptr<User> requester)
   // create instance of payment object with inputed card information
   Payment payment(total, card_number, cvv, expiration_date);
 
-  // Count the duration of this event against the user's booked hours
-  if (auto citizen_ptr = dynamic_pointer_cast<Citizen>(requester))
-    citizen_ptr->set_booked_hours(citizen_ptr->get_booked_hours() + duration);
-  else if (auto client_ptr = dynamic_pointer_cast<Client>(requester))
-    client_ptr->set_booked_hours(client_ptr->get_booked_hours() + duration);
-
-  manager->add_to_balance(total);
-  cout << "Event requested successfully!" << endl;
   ReservationRequest request(dt, static_cast<Event::LayoutType>(layout_type),
                              static_cast<Event::GuestType>(guest_type), is_public, price_per_ticket, duration, payment, requester);
-  this->add_pending_event(request);
+  this->submit_reservation_request(request);
+  cout << "Event requested successfully!" << endl;
 }
 
 void Facility::cancel_event(shared_ptr<User> requester)
@@ -305,10 +633,8 @@ void Facility::cancel_event(shared_ptr<User> requester)
    * The service charge in not refundable
    */
   // case the requester to display their events
-  if (auto citizen_ptr = dynamic_pointer_cast<Citizen>(requester))
-    citizen_ptr->display_my_events();
-  else if (auto client_ptr = dynamic_pointer_cast<Client>(requester))
-    client_ptr->display_my_events();
+  load_event_history();
+  requester->display_my_events();
 
   cout << "Enter the date of the event to cancel (MM/DD/YYYY): ";
   string date = prompt::get_user_date_input();
@@ -323,60 +649,24 @@ void Facility::cancel_event(shared_ptr<User> requester)
     return;
   }
 
-  for (const Event &event : confirmed_events)
+  shared_ptr<Event> event = find_confirmed_event(event_dt);
+  if (event == nullptr)
   {
-    if (event.get_dt() == event_dt)
-    {
-      double refund;
-
-      int time_difference = event_dt.hours_difference(mock_dt);
-      if (time_difference > 168) // More than a week
-        refund = event.get_payment().get_amount() - 10;
-      else if (time_difference > 24 && time_difference <= 168) // Between 24 hours and a week
-        refund = (event.get_payment().get_amount() - 10) * 0.99;
-      else // Less than 24 hours
-        refund = 0;
-
-      cout << "You will be refunded $" << refund << " for the event." << endl;
-
-      // Remove the event from the user's booked hours and list of events
-      if (auto citizen_ptr = dynamic_pointer_cast<Citizen>(requester))
-      {
-        citizen_ptr->set_booked_hours(citizen_ptr->get_booked_hours() - event.get_duration());
-        citizen_ptr->remove_event(event);
-      }
-      else if (auto client_ptr = dynamic_pointer_cast<Client>(requester))
-      {
-        client_ptr->set_booked_hours(client_ptr->get_booked_hours() - event.get_duration());
-        client_ptr->remove_event(event);
-      }
-
-      // Money to be paid
-      manager->subtract_from_balance(refund);
-
-      // Refund the user
-      event.get_organizer()->add_to_balance(refund);
-
-      // Refund the tickets
-      for (auto &ticket : event.get_tickets())
-      {
-        manager->subtract_from_balance(event.get_price_per_ticket());
-        ticket.refund(event.get_price_per_ticket());
-      }
+    cout << "Event not found." << endl;
+    return;
+  }
 
-      // Remove the event from the confirmed events
-      this->remove_confirmed_event(event);
+  double refund = pricing::cancellation_refund(event->get_organizer()->get_category(), event->get_payment().get_amount(),
+                                              event_dt.hours_difference(mock_dt));
 
-      cout << "Event canceled successfully!" << endl;
-      return;
-    }
-  }
-  cout << "Event not found." << endl;
+  cout << "You will be refunded $" << refund << " for the event." << endl;
+  this->cancel_confirmed_event(event, refund);
+  cout << "Event canceled successfully!" << endl;
 }
 
 void Facility::request_ticket(shared_ptr<User> requester)
 {
-  auto citizen_ptr = dynamic_pointer_cast<Citizen>(requester);
+  shared_ptr<Citizen> citizen_ptr = Citizen::from_user(requester);
   display_schedule();
   cout << "Enter the date of the event to request a ticket for (MM/DD/YYYY): ";
   string date = prompt::get_user_date_input();
@@ -384,120 +674,120 @@ void Facility::request_ticket(shared_ptr<User> requester)
   string time = prompt::get_user_time_input();
   DateTime event_dt(date, time);
 
-  for (auto &event : confirmed_events)
+  shared_ptr<Event> found = find_confirmed_event(event_dt);
+  if (found == nullptr)
   {
-    if (event.get_dt() == event_dt)
-    {
-      if (!event.get_is_public())
-      {
-        cout << "This event is private and does not have tickets for sale." << endl;
-        return;
-      }
-      // check if the user already has a ticket for this event
-      for (const auto &ticket : event.get_tickets())
-      {
-        if (ticket.get_holder_username() == citizen_ptr->get_username())
-        {
-          cout << "You already have a ticket for this event." << endl;
-          return;
-        }
-      }
-      if (event.get_guest_type() == Event::GuestType::RESIDENTS && citizen_ptr->get_resident_status() == Citizen::ResidentStatus::NONRESIDENT)
-      {
-        cout << "This event is for residents only." << endl;
-        return;
-      }
-      if (event.get_guest_type() == Event::GuestType::NONRESIDENTS && citizen_ptr->get_resident_status() == Citizen::ResidentStatus::RESIDENT)
-      {
-        cout << "This event is for non-residents only." << endl;
-        return;
-      }
-      double total = event.get_price_per_ticket();
-      cout << "Your total is $" << total << ".\n";
-      cout << "Enter the payment information below:" << endl;
-      cout << "Enter the card number: ";
-      long card_number;
-      while (true)
-      {
-        cin >> card_number;
-        if (card_number < 1000000000000000 || card_number > 9999999999999999)
-        {
-          cin.clear();
-          cin.ignore(numeric_limits<streamsize>::max(), '\n');
-          cout << "Invalid card number (must be 16 numbers). Please try again." << endl;
-        }
-        else
-        {
-          break;
-        }
-      }
-      cout << "Enter the CVV: ";
-      int cvv;
-      while (true)
-      {
-        cin >> cvv;
-        if (cvv < 100 || cvv > 999)
-        {
-          cin.clear();
-          cin.ignore(numeric_limits<streamsize>::max(), '\n');
-          cout << "Invalid CVV. Please try again." << endl;
-        }
-        else
-        {
-          break;
-        }
-      }
-      cout << "Enter the expiration date (MM/YY): ";
-      string expiration_date;
-      while (true)
-      {
-        cin >> expiration_date;
-        if (expiration_date.length() != 5 || expiration_date[2] != '/')
-        {
-          cin.clear();
-          cin.ignore(numeric_limits<streamsize>::max(), '\n');
-          cout << "Invalid expiration date. Please try again." << endl;
-        }
-        else
-        {
-          int month = stoi(expiration_date.substr(0, 2));
-          int year = stoi(expiration_date.substr(3, 2));
-          if (year < 24 || (year == 24 && month <= 5))
-          {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            cout << "Invalid date. The date must be later than 05/24. Please try again" << endl;
-          }
-          else
-          {
-            break;
-          }
-        }
-      }
+    cout << "Event not found." << endl;
+    return;
+  }
+  Event &event = *found;
 
-      if (event.get_tickets().size() >= static_cast<size_t>(event.get_capacity()))
+  if (!event.get_is_public())
+  {
+    cout << "This event is private and does not have tickets for sale." << endl;
+    return;
+  }
+  // check if the user already has a ticket for this event
+  if (event.find_ticket(citizen_ptr) != nullptr)
+  {
+    cout << "You already have a ticket for this event." << endl;
+    return;
+  }
+  if (size_t position = event.waitlist_position(citizen_ptr))
+  {
+    cout << "You are already number " << position << " on the waitlist for this event." << endl;
+    return;
+  }
+  if (event.get_guest_type() == Event::GuestType::RESIDENTS && citizen_ptr->get_resident_status() == Citizen::ResidentStatus::NONRESIDENT)
+  {
+    cout << "This event is for residents only." << endl;
+    return;
+  }
+  if (event.get_guest_type() == Event::GuestType::NONRESIDENTS && citizen_ptr->get_resident_status() == Citizen::ResidentStatus::RESIDENT)
+  {
+    cout << "This event is for non-residents only." << endl;
+    return;
+  }
+  double total = event.get_price_per_ticket();
+  cout << "Your total is $" << total << ".\n";
+  cout << "Enter the payment information below:" << endl;
+  cout << "Enter the card number: ";
+  long card_number;
+  while (true)
+  {
+    cin >> card_number;
+    if (card_number < 1000000000000000 || card_number > 9999999999999999)
+    {
+      cin.clear();
+      cin.ignore(numeric_limits<streamsize>::max(), '\n');
+      cout << "Invalid card number (must be 16 numbers). Please try again." << endl;
+    }
+    else
+    {
+      break;
+    }
+  }
+  cout << "Enter the CVV: ";
+  int cvv;
+  while (true)
+  {
+    cin >> cvv;
+    if (cvv < 100 || cvv > 999)
+    {
+      cin.clear();
+      cin.ignore(numeric_limits<streamsize>::max(), '\n');
+      cout << "Invalid CVV. Please try again." << endl;
+    }
+    else
+    {
+      break;
+    }
+  }
+  cout << "Enter the expiration date (MM/YY): ";
+  string expiration_date;
+  while (true)
+  {
+    cin >> expiration_date;
+    if (expiration_date.length() != 5 || expiration_date[2] != '/')
+    {
+      cin.clear();
+      cin.ignore(numeric_limits<streamsize>::max(), '\n');
+      cout << "Invalid expiration date. Please try again." << endl;
+    }
+    else
+    {
+      int month = stoi(expiration_date.substr(0, 2));
+      int year = stoi(expiration_date.substr(3, 2));
+      if (year < 24 || (year == 24 && month <= 5))
       {
-        cout << "This event is sold out, you have been added to the waitlist." << endl;
-        event.add_to_waitlist(citizen_ptr);
-        return;
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Invalid date. The date must be later than 05/24. Please try again" << endl;
       }
       else
       {
-        auto new_ticket = make_shared<Ticket>(citizen_ptr, make_shared<Event>(event));
-        event.add_ticket(*new_ticket);
-        citizen_ptr->add_ticket(*new_ticket);
-        manager->add_to_balance(total);
-        cout << "Ticket purchased successfully!" << endl;
-        return;
+        break;
       }
     }
   }
-  cout << "Event not found." << endl;
+
+  if (event.get_tickets().size() >= static_cast<size_t>(event.get_capacity()))
+  {
+    this->add_to_waitlist(event, citizen_ptr);
+    cout << "This event is sold out, you have been added to the waitlist at number "
+         << event.waitlist_position(citizen_ptr) << "." << endl;
+  }
+  else
+  {
+    this->purchase_ticket(event, citizen_ptr);
+    cout << "Ticket purchased successfully!" << endl;
+  }
 }
 
 void Facility::refund_ticket(shared_ptr<User> requester)
 {
-  auto citizen_ptr = dynamic_pointer_cast<Citizen>(requester);
+  shared_ptr<Citizen> citizen_ptr = Citizen::from_user(requester);
+  load_event_history();
   citizen_ptr->display_my_tickets();
 
   cout << "Enter the date of the ticket to refund (MM/DD/YYYY): ";
@@ -513,54 +803,52 @@ void Facility::refund_ticket(shared_ptr<User> requester)
     return;
   }
 
-  for (Event &event : confirmed_events)
+  shared_ptr<Event> event = find_confirmed_event(event_dt);
+  if (event != nullptr && this->withdraw_from_waitlist(*event, citizen_ptr))
+    cout << "You have been removed from the waitlist." << endl;
+  else if (event == nullptr || !this->return_ticket(*event, citizen_ptr))
+    cout << "Ticket not found." << endl;
+}
+
+void Facility::display_free_hours(const DateTime &day) const
+{
+  vector<Slot> free_hours = available_slots(day, day, 1);
+  if (free_hours.empty())
   {
-    if (event.get_dt() == event_dt)
-    {
-      for (Ticket &ticket : event.get_tickets())
-      {
-        if (ticket.get_holder_username() == citizen_ptr->get_username())
-        {
-          manager->subtract_from_balance(event.get_price_per_ticket());
-          event.remove_ticket(ticket);
-          ticket.refund(event.get_price_per_ticket());
-
-          // checks if the waitlist is not empty if so it will create a ticket for the first person in the waitlist
-          if (!event.get_waitlist().empty())
-          {
-            shared_ptr<Citizen> citizen = event.get_waitlist().front();
-            auto new_ticket = Ticket(citizen, make_shared<Event>(event));
-            event.add_ticket(new_ticket);
-            citizen->add_ticket(new_ticket);
-            event.get_waitlist().pop();
-            manager->add_to_balance(event.get_price_per_ticket());
-          }
-          return;
-        }
-      }
-    }
+    cout << "There are no free hours on " << day.get_date_str() << "." << endl;
+    return;
+  }
+
+  // Join consecutive free hours into ranges
+  cout << "Free hours on " << day.get_date_str() << ":";
+  for (size_t i = 0; i < free_hours.size();)
+  {
+    size_t j = i + 1;
+    while (j < free_hours.size() && free_hours[j].hour == free_hours[j - 1].hour + 1)
+      j++;
+    cout << (i == 0 ? " " : ", ") << hour_to_time_str(free_hours[i].hour) << "-" << hour_to_time_str(free_hours[j - 1].hour + 1);
+    i = j;
   }
-  cout << "Ticket not found." << endl;
+  cout << endl;
 }
 
 void Facility::display_schedule() const
 {
   cout << "Facility Schedule:" << endl;
-  for (const auto &event : confirmed_events)
-  {
-    if (event.get_dt().is_same_day_or_after(mock_dt))
-      cout << event << endl;
-  }
+  for (auto it = confirmed_events.lower_bound(day_start_minutes(mock_dt)); it != confirmed_events.end(); ++it)
+    cout << *it->second << endl;
 }
 
-void Facility::load_saved_confirmed_events(const vector<Event> &events)
+void Facility::load_saved_confirmed_events(vector<shared_ptr<Event>> events)
 {
-  for (const auto &e : events)
-    this->add_confirmed_event(e);
+  event_slots.reserve(confirmed_events.size() + events.size());
+  for (shared_ptr<Event> &e : events)
+    schedule(move(e));
 }
 
 void Facility::load_saved_pending_events(const vector<ReservationRequest> &events)
 {
+  pending_events.reserve(pending_events.size() + events.size());
   for (const auto &e : events)
     this->add_pending_event(e);
 }
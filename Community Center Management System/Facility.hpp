@@ -5,16 +5,71 @@
 #include "ReservationRequest.hpp"
 #include "FacilityManager.hpp"
 #include "DateTime.hpp"
+#include "Journal.hpp"
+#include "EventArchive.hpp"
+#include "IntervalIndex.hpp"
+#include "PendingRequests.hpp"
+#include <cstdint>
+#include <map>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 class Facility
 {
+public:
+  /**
+   * The start of a free run of hours in the Facility's schedule.
+   */
+  struct Slot
+  {
+    long long day; // days since 01/01/1970
+    int hour;
+  };
+
 private:
-  vector<Event> confirmed_events;
-  vector<ReservationRequest> pending_events; // events that are waiting for approval by the facility manager
+  // upcoming events by start minute; past ones are moved to the archive. Each Event is allocated once
+  // and its handle is shared with its organizer, while its Tickets refer to it by address.
+  Schedule confirmed_events;
+  PendingRequests pending_events; // events that are waiting for approval by the facility manager
+  IntervalIndex booked_times; // the minutes each confirmed event takes up
+  unordered_map<long long, uint16_t> occupancy; // day number to the hours booked on it, bit 0 being 08:00
+  unordered_map<long long, Schedule::iterator> event_slots; // start minute to the first event starting then
   shared_ptr<User> manager;
   DateTime mock_dt;
+  Journal *journal; // records every state mutation, if attached
+  EventArchive *archive; // holds the events before mock_dt's day, if attached
+
+  /**
+   * Appends a record to the attached Journal, if any.
+   */
+  void log(Journal::RecordType type, const string &payload);
+  /**
+   * Adds the time a confirmed Event takes up to booked_times and occupancy.
+   */
+  void book(const Event &event);
+  /**
+   * Removes the time a confirmed Event takes up from booked_times and occupancy.
+   */
+  void unbook(const Event &event);
+  /**
+   * Adds a confirmed Event to the schedule, event_slots, booked_times and occupancy.
+   */
+  void schedule(shared_ptr<Event> event);
+  /**
+   * Removes a confirmed Event from the schedule, event_slots, booked_times and occupancy.
+   *
+   * @return the position after the removed Event
+   */
+  Schedule::iterator unschedule(Schedule::iterator position);
+  /**
+   * Sells the open seats of a confirmed Event to the Citizens at the front of its waitlist, in order.
+   */
+  void promote_waitlist(Event &event);
+  /**
+   * Displays the free hours on the day of the given DateTime.
+   */
+  void display_free_hours(const DateTime &day) const;
 
 public:
   Facility(shared_ptr<User> manager, const DateTime &dt);
@@ -23,23 +78,23 @@ public:
   /**
    * Gets the confirmed events in the Facility.
    *
-   * @return the confirmed events in the Facility.
+   * @return the handles of the confirmed events in the Facility, by start minute
    */
-  vector<Event> get_confirmed_events() const;
+  const Schedule &get_confirmed_events() const;
   /**
    * Gets the pending events in the Facility.
    *
-   * @return the pending events in the Facility
+   * @return the pending events in the Facility, in submission order
    */
-  vector<ReservationRequest> get_pending_events() const;
+  const PendingRequests &get_pending_events() const;
 
   // system backend functions
   /**
    * Adds an event as a confirmed event to this Facility.
    *
-   * @param event the event to be added to the confirmed events
+   * @param event the handle of the event to be added to the confirmed events
    */
-  void add_confirmed_event(const Event &event);
+  void add_confirmed_event(const shared_ptr<Event> &event);
   /**
    * Removes an event from the confirmed events of this Facility.
    *
@@ -55,9 +110,141 @@ public:
   /**
    * Removes a pending event from this Facility.
    *
-   * @param event the event to be removed from the pending events
+   * @param id the ID of the event to be removed from the pending events
+   */
+  void remove_pending_event(PendingRequests::Id id);
+  /**
+   * Finds the confirmed Event at the given DateTime.
+   *
+   * @param dt the DateTime of the Event
+   * @return the handle of the Event, or nullptr if there is none
+   */
+  shared_ptr<Event> find_confirmed_event(const DateTime &dt) const;
+  /**
+   * Finds the pending ReservationRequest at the given DateTime.
+   *
+   * @param dt the DateTime of the ReservationRequest
+   * @return the ReservationRequest, or nullptr if there is none
+   */
+  const ReservationRequest *find_pending_event(const DateTime &dt) const;
+  /**
+   * Does a confirmed Event take up any of the given time?
+   *
+   * @param start the start of the time
+   * @param duration the length of the time in hours
+   * @return does a confirmed Event overlap the time
+   */
+  bool is_booked(const DateTime &start, const int &duration) const;
+  /**
+   * Finds the confirmed Events that take up any of the given time.
+   *
+   * @param start the start of the time
+   * @param duration the length of the time in hours
+   * @return the overlapping Events in order of their start, valid until the confirmed Events change
+   */
+  vector<const Event *> events_overlapping(const DateTime &start, const int &duration) const;
+  /**
+   * Finds the confirmed Events that start in the given time.
+   *
+   * @param from the start of the time
+   * @param to the end of the time, which is left out
+   * @return the Events in order of their start, valid until the confirmed Events change
+   */
+  vector<const Event *> schedule_range(const DateTime &from, const DateTime &to) const;
+  /**
+   * Finds every start time from which the given number of hours is free, on each day from the first to
+   * the last. Times before the mock date and time are left out.
+   *
+   * @param first a DateTime on the first day
+   * @param last a DateTime on the last day
+   * @param duration the number of hours
+   * @return the start of each free run, in order
    */
-  void remove_pending_event(const ReservationRequest &event);
+  vector<Slot> available_slots(const DateTime &first, const DateTime &last, const int &duration) const;
+
+  // state mutations, shared by the menus and Journal replay
+  /**
+   * Submits a ReservationRequest for approval, counting its duration against the requester's booked hours
+   * and paying its cost to the FacilityManager.
+   *
+   * @param request the ReservationRequest
+   */
+  void submit_reservation_request(const ReservationRequest &request);
+  /**
+   * Approves a pending ReservationRequest, confirming its Event and adding it to the requester's events.
+   *
+   * @param id the ID of the pending ReservationRequest
+   */
+  void approve_reservation_request(PendingRequests::Id id);
+  /**
+   * Sells a Ticket for a confirmed Event to a Citizen.
+   *
+   * @param event the confirmed Event
+   * @param citizen the Citizen buying the Ticket
+   */
+  void purchase_ticket(Event &event, const shared_ptr<Citizen> &citizen);
+  /**
+   * Adds a Citizen to the waitlist of a sold out Event, unless they are already on it.
+   *
+   * @param event the confirmed Event
+   * @param citizen the Citizen to add to the waitlist
+   * @return was the Citizen added
+   */
+  bool add_to_waitlist(Event &event, const shared_ptr<Citizen> &citizen);
+  /**
+   * Removes a Citizen from the waitlist of an Event.
+   *
+   * @param event the confirmed Event
+   * @param citizen the Citizen leaving the waitlist
+   * @return was the Citizen on the waitlist
+   */
+  bool withdraw_from_waitlist(Event &event, const shared_ptr<Citizen> &citizen);
+  /**
+   * Refunds a Citizen's Ticket for an Event, giving the seat to the next Citizen on the waitlist.
+   *
+   * @param event the confirmed Event
+   * @param citizen the Citizen holding the Ticket
+   * @return did the Citizen hold a Ticket for the Event
+   */
+  bool return_ticket(Event &event, const shared_ptr<Citizen> &citizen);
+  /**
+   * Cancels a confirmed Event, refunding the organizer and every ticket holder.
+   *
+   * @param event the handle of the confirmed Event
+   * @param refund the amount refunded to the organizer
+   */
+  void cancel_confirmed_event(const shared_ptr<Event> &event, const double &refund);
+  /**
+   * Attaches a Journal that every state mutation of this Facility is recorded to.
+   *
+   * @param journal the Journal, or nullptr to stop recording
+   */
+  void attach_journal(Journal *journal);
+  /**
+   * Commits the records of the last user action to the attached Journal, if any.
+   */
+  void commit_journal();
+  /**
+   * Attaches the EventArchive that past Events are moved to.
+   *
+   * @param archive the EventArchive, or nullptr to keep every Event in this Facility
+   */
+  void attach_archive(EventArchive *archive);
+  /**
+   * Moves every confirmed Event on a day before the mock date into the attached EventArchive. If the
+   * archive holds Events on or after the mock date, which happens when the mock date moves back, they
+   * are moved back into this Facility first.
+   */
+  void archive_past_events();
+  /**
+   * Loads the archived Events into their Users' tickets and events, so that User histories are complete.
+   */
+  void load_event_history();
+  /**
+   * Rewrites the attached EventArchive if Events were moved out of it.
+   */
+  void save_archive();
+
   /**
    * Creates a ReservationRequest for an Event for the given User.
    *
@@ -81,9 +268,7 @@ public:
    */
   void refund_ticket(shared_ptr<User> requester);
   /**
-   * Calculates the cost of reserving an Event.
-   * There is a service charge of $10, and an hourly rate of $10 for Residents, $15 for Non-Residents,
-   * $20 for Organizations, and $5 for the City.
+   * Calculates the cost of reserving an Event, as priced by pricing::reservation_cost.
    *
    * @param requester the user that reserved the Event
    * @param duration the duration of the event (in hours)
@@ -99,9 +284,9 @@ public:
   /**
    * Loads a vector of Events into this Facility's confirmed Events.
    *
-   * @param events the events to load
+   * @param events the handles of the events to load, which are moved into the Facility
    */
-  void load_saved_confirmed_events(const vector<Event> &events);
+  void load_saved_confirmed_events(vector<shared_ptr<Event>> events);
   /**
    * Loads a vector of ReservationRequest into this Facility's pending Events.
    *
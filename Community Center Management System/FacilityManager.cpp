@@ -3,7 +3,18 @@
 
 using namespace std;
 
-FacilityManager::FacilityManager(const string &username, const string &password) : User(username, password) {}
+namespace
+{
+  const size_t PAGE_SIZE = 20; // pending requests listed at once
+
+  // Indexed by PendingRequests::Order and PendingRequests::RequesterType
+  const char *ORDER_NAMES[] = {"by submission time", "by event start", "by requester type"};
+  const int ORDER_COUNT = 3;
+  const char *REQUESTER_NAMES[] = {"the city", "residents", "non-residents", "organizations", "other users", "everyone"};
+  const int REQUESTER_COUNT = 6;
+}
+
+FacilityManager::FacilityManager(const string &username, const string &password) : User(username, password, User::MANAGER) {}
 
 void FacilityManager::display_menu()
 {
@@ -48,6 +59,7 @@ void FacilityManager::handle_menu_input(Facility &facility)
       cout << "Invalid option. Please try again." << endl;
       continue;
     }
+    facility.commit_journal();
     while (true)
     {
       string return_to_menu;
@@ -73,49 +85,55 @@ void FacilityManager::handle_menu_input(Facility &facility)
   }
 }
 
-void FacilityManager::approve_event_request(Facility &facility, const ReservationRequest &request)
+void FacilityManager::approve_event_request(Facility &facility, PendingRequests::Id request)
 {
-  // Create an Event from the ReservationRequest
-  Event created_event = request.create_event();
-
-  // Remove the event from the pending Events
-  facility.remove_pending_event(request);
-
-  // Confirm the Event in the facility
-  facility.add_confirmed_event(created_event);
-
-  // add the event to the user's list of events
-  if (auto citizen_ptr = dynamic_pointer_cast<Citizen>(request.get_requester()))
-  {
-    citizen_ptr->add_event(created_event);
-  }
-  else if (auto client_ptr = dynamic_pointer_cast<Client>(request.get_requester()))
-  {
-    client_ptr->add_event(created_event);
-  }
+  facility.approve_reservation_request(request);
 }
 
 void FacilityManager::handle_event_approvals(Facility &facility)
 {
-  vector<ReservationRequest> pending_events = facility.get_pending_events();
+  const PendingRequests &pending_events = facility.get_pending_events();
 
   if (pending_events.size() == 0)
   {
     cout << "There are no pending events to approve." << endl;
+    return;
   }
-  else
+
+  // Short backlogs are listed whole; longer ones a page at a time, with options to reorder and filter them
+  bool paged = pending_events.size() > PAGE_SIZE;
+  PendingRequests::Order order = PendingRequests::SUBMITTED;
+  PendingRequests::RequesterType type = PendingRequests::ALL;
+  PendingRequests::Id after = PendingRequests::NONE; // the last request on the previous page
+  while (true)
   {
-    cout << "Enter the number of a Reservation Request to approve:" << endl;
-    for (size_t i = 0; i < pending_events.size(); i++)
-      cout << to_string(i + 1) << ": " << pending_events[i] << endl;
-    size_t none_option = pending_events.size() + 1;
+    bool more;
+    vector<PendingRequests::Id> page = pending_events.page(order, after, paged ? PAGE_SIZE : pending_events.size(), type, more);
+    if (paged)
+      cout << pending_events.size() << " pending requests, " << ORDER_NAMES[order] << ", from "
+           << REQUESTER_NAMES[type] << ":" << endl;
+    if (page.empty())
+      cout << "No pending requests match." << endl;
+    else
+      cout << "Enter the number of a Reservation Request to approve:" << endl;
+    for (size_t i = 0; i < page.size(); i++)
+      cout << to_string(i + 1) << ": " << *pending_events.get(page[i]) << endl;
+    size_t none_option = page.size() + 1;
+    size_t next_option = none_option + 1, order_option = none_option + 2, type_option = none_option + 3;
     cout << to_string(none_option) << ": Approve none of these requests" << endl;
+    if (paged)
+    {
+      cout << to_string(next_option) << ": " << (more ? "Show the next page" : "Show the first page") << endl;
+      cout << to_string(order_option) << ": Order " << ORDER_NAMES[(order + 1) % ORDER_COUNT] << endl;
+      cout << to_string(type_option) << ": Show requests from " << REQUESTER_NAMES[(type + 1) % REQUESTER_COUNT] << endl;
+    }
+    size_t last_option = paged ? type_option : none_option;
 
     size_t option;
     while (true)
     {
       cin >> option;
-      if (option < 1 || option > none_option)
+      if (option < 1 || option > last_option)
       {
         cin.clear();
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
@@ -123,18 +141,41 @@ void FacilityManager::handle_event_approvals(Facility &facility)
       }
       else
       {
-        if (option == none_option)
-        {
-          cout << "Approving none of these requests." << endl;
-          return;
-        }
-        else
-        {
-          cout << "Approving event: " << pending_events[option - 1] << endl;
-          approve_event_request(facility, pending_events[option - 1]);
-          return;
-        }
+        break;
+      }
+    }
+
+    if (option == none_option)
+    {
+      cout << "Approving none of these requests." << endl;
+      return;
+    }
+    else if (option == next_option)
+    {
+      after = more ? page.back() : PendingRequests::NONE;
+    }
+    else if (option == order_option)
+    {
+      order = static_cast<PendingRequests::Order>((order + 1) % ORDER_COUNT);
+      after = PendingRequests::NONE;
+    }
+    else if (option == type_option)
+    {
+      type = static_cast<PendingRequests::RequesterType>((type + 1) % REQUESTER_COUNT);
+      after = PendingRequests::NONE;
+    }
+    else
+    {
+      PendingRequests::Id id = page[option - 1];
+      const ReservationRequest &request = *pending_events.get(id);
+      if (facility.is_booked(request.get_dt(), request.get_duration()))
+      {
+        cout << "This request overlaps a confirmed event and cannot be approved." << endl;
+        return;
       }
+      cout << "Approving event: " << request << endl;
+      approve_event_request(facility, id);
+      return;
     }
   }
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 #include "User.hpp"
 #include "Event.hpp"
 #include "ReservationRequest.hpp"
+#include "PendingRequests.hpp"
 #include "Ticket.hpp"
 #include "Payment.hpp"
 #include "Facility.hpp"
@@ -19,11 +20,12 @@ public:
    * Approves an event in the Facility.
    *
    * @param facility the Facility
-   * @param request the ReservationRequest to approve
+   * @param request the ID of the pending ReservationRequest to approve
    */
-  void approve_event_request(Facility &facility, const ReservationRequest &request);
+  void approve_event_request(Facility &facility, PendingRequests::Id request);
   /**
-   * Displays all events pending approval in the Facility and allows the User to choose one to approve.
+   * Displays the events pending approval in the Facility a page at a time and allows the User to choose
+   * one to approve. A backlog longer than a page can also be reordered and filtered by requester type.
    *
    * @param facility the Facility
    */
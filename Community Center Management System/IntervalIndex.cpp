@@ -0,0 +1,58 @@
+#include "IntervalIndex.hpp"
+#include <algorithm>
+
+using namespace std;
+
+IntervalIndex::IntervalIndex() : max_length(0) {}
+
+void IntervalIndex::insert(long long start, long long end)
+{
+  intervals.emplace(start, end);
+  max_length = max(max_length, end - start);
+}
+
+void IntervalIndex::erase(long long start, long long end)
+{
+  auto range = intervals.equal_range(start);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second == end)
+    {
+      intervals.erase(it);
+      return;
+    }
+  }
+}
+
+void IntervalIndex::clear()
+{
+  intervals.clear();
+  max_length = 0;
+}
+
+bool IntervalIndex::overlaps(long long start, long long end) const
+{
+  for (auto it = first_candidate(start); it != intervals.end() && it->first < end; ++it)
+  {
+    if (it->second > start)
+      return true;
+  }
+  return false;
+}
+
+vector<pair<long long, long long>> IntervalIndex::overlapping(long long start, long long end) const
+{
+  vector<pair<long long, long long>> result;
+  for (auto it = first_candidate(start); it != intervals.end() && it->first < end; ++it)
+  {
+    if (it->second > start)
+      result.push_back(*it);
+  }
+  return result;
+}
+
+multimap<long long, long long>::const_iterator IntervalIndex::first_candidate(long long start) const
+{
+  // No interval is longer than max_length, so any interval starting this early has ended by start
+  return intervals.upper_bound(start - max_length);
+}
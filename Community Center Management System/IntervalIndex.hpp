@@ -0,0 +1,61 @@
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A set of half-open intervals [start, end), ordered by start, that answers which intervals overlap
+ * a window. The longest interval ever added bounds how far before a window an overlapping interval
+ * can start, so a query only visits the intervals starting in that range; for intervals that don't
+ * overlap each other and have a bounded length, like the events of a day, that is O(log n).
+ */
+class IntervalIndex
+{
+public:
+  IntervalIndex();
+
+  /**
+   * Adds an interval. The same interval may be added more than once.
+   *
+   * @param start the start of the interval
+   * @param end the end of the interval, after its start
+   */
+  void insert(long long start, long long end);
+  /**
+   * Removes one copy of an interval, if it is in the index.
+   *
+   * @param start the start of the interval
+   * @param end the end of the interval
+   */
+  void erase(long long start, long long end);
+  /**
+   * Removes every interval.
+   */
+  void clear();
+
+  /**
+   * Does any interval overlap the window?
+   *
+   * @param start the start of the window
+   * @param end the end of the window
+   * @return does an interval share some of the window
+   */
+  bool overlaps(long long start, long long end) const;
+  /**
+   * Gets every interval that overlaps the window.
+   *
+   * @param start the start of the window
+   * @param end the end of the window
+   * @return the overlapping intervals as start and end pairs, ordered by start
+   */
+  vector<pair<long long, long long>> overlapping(long long start, long long end) const;
+
+private:
+  multimap<long long, long long> intervals; // start to end
+  long long max_length;                     // of any interval added since the last clear
+
+  multimap<long long, long long>::const_iterator first_candidate(long long start) const;
+};
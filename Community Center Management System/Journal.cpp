@@ -0,0 +1,143 @@
+#include "Journal.hpp"
+#include "Facility.hpp"
+#include "fileio.hpp"
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+  const char *RECORD_NAMES[] = {"REGISTER", "REQUEST", "APPROVE", "TICKET", "WAITLIST", "REFUND", "CANCEL", "WITHDRAW"};
+  const size_t GROUP_COMMIT_SIZE = 64; // records buffered before a commit is forced
+}
+
+Journal::Journal(const string &file_path) : file_path(file_path), buffered_records(0), record_count(0)
+{
+  fd = open(file_path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (fd < 0)
+    cout << "Error write to file: " << file_path << endl;
+}
+
+Journal::~Journal()
+{
+  commit();
+  if (fd >= 0)
+    close(fd);
+}
+
+void Journal::append(RecordType type, const string &payload)
+{
+  buffer += RECORD_NAMES[type];
+  buffer += ',';
+  buffer += payload;
+  buffer += '\n';
+  buffered_records++;
+  record_count++;
+
+  if (buffered_records >= GROUP_COMMIT_SIZE)
+    commit();
+}
+
+void Journal::commit()
+{
+  if (buffer.empty() || fd < 0)
+    return;
+
+  const char *data = buffer.data();
+  size_t remaining = buffer.size();
+  while (remaining > 0)
+  {
+    ssize_t written = write(fd, data, remaining);
+    if (written < 0)
+    {
+      cout << "Error write to file: " << file_path << endl;
+      break;
+    }
+    data += written;
+    remaining -= written;
+  }
+  fdatasync(fd);
+
+  buffer.clear();
+  buffered_records = 0;
+}
+
+size_t Journal::get_record_count() const { return record_count; }
+
+void Journal::reset()
+{
+  buffer.clear();
+  buffered_records = 0;
+  record_count = 0;
+  if (fd >= 0 && ftruncate(fd, 0) == 0)
+    fsync(fd);
+}
+
+void Journal::replay(UserDirectory &users, Facility &facility)
+{
+  fileio::MappedFile file(file_path);
+  string_view content = file.content();
+
+  // A crash can leave the last record partially written, so only complete lines are replayed
+  size_t complete = content.rfind('\n');
+  content = complete == string_view::npos ? string_view() : content.substr(0, complete + 1);
+
+  string_view line;
+  while (fileio::next_line(content, line))
+  {
+    if (line.empty())
+      continue;
+    record_count++;
+
+    string_view type = fileio::next_field(line, ',');
+    if (type == RECORD_NAMES[REGISTER])
+    {
+      users.add(user_utils::csv_to_user(line));
+    }
+    else if (type == RECORD_NAMES[REQUEST])
+    {
+      ReservationRequest request = event_utils::csv_to_pending_event(line, users);
+      if (request.get_requester() && !facility.find_pending_event(request.get_dt()) &&
+          !facility.find_confirmed_event(request.get_dt()))
+        facility.submit_reservation_request(request);
+    }
+    else if (type == RECORD_NAMES[APPROVE])
+    {
+      string_view date = fileio::next_field(line, ',');
+      string_view time = fileio::next_field(line, ',');
+      PendingRequests::Id request = facility.get_pending_events().find(DateTime(date, time));
+      if (request != PendingRequests::NONE)
+        facility.approve_reservation_request(request);
+    }
+    else if (type == RECORD_NAMES[CANCEL])
+    {
+      string_view date = fileio::next_field(line, ',');
+      string_view time = fileio::next_field(line, ',');
+      double refund = fileio::to_double(fileio::next_field(line, ','));
+      shared_ptr<Event> event = facility.find_confirmed_event(DateTime(date, time));
+      if (event)
+        facility.cancel_confirmed_event(event, refund);
+    }
+    else
+    {
+      // TICKET, WAITLIST, REFUND and WITHDRAW all name an Event and a Citizen
+      string_view date = fileio::next_field(line, ',');
+      string_view time = fileio::next_field(line, ',');
+      shared_ptr<Event> event = facility.find_confirmed_event(DateTime(date, time));
+      shared_ptr<Citizen> citizen = Citizen::from_user(users.find(fileio::next_field(line, ',')));
+      if (!event || !citizen)
+        continue;
+
+      if (type == RECORD_NAMES[TICKET] && !event->find_ticket(citizen))
+        facility.purchase_ticket(*event, citizen);
+      else if (type == RECORD_NAMES[WAITLIST])
+        facility.add_to_waitlist(*event, citizen);
+      else if (type == RECORD_NAMES[REFUND])
+        facility.return_ticket(*event, citizen);
+      else if (type == RECORD_NAMES[WITHDRAW])
+        facility.withdraw_from_waitlist(*event, citizen);
+    }
+  }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "UserDirectory.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+class Facility;
+
+/**
+ * An append-only log of every mutation made to the program state since it was last saved. Records
+ * are buffered and written with a single write and fsync per commit, so one user action costs one
+ * fsync no matter how many records it produces. On startup the journal is replayed on top of the
+ * saved state, and it is emptied whenever the state is saved (compacted) again.
+ */
+class Journal
+{
+public:
+  enum RecordType
+  {
+    REGISTER, // REGISTER,<users.csv line>
+    REQUEST,  // REQUEST,<pending_events.csv line>
+    APPROVE,  // APPROVE,date,time
+    TICKET,   // TICKET,date,time,username
+    WAITLIST, // WAITLIST,date,time,username
+    REFUND,   // REFUND,date,time,username
+    CANCEL,   // CANCEL,date,time,refund
+    WITHDRAW  // WITHDRAW,date,time,username
+  };
+
+  /**
+   * Opens the journal file for appending, creating it if needed.
+   *
+   * @param file_path the journal file path
+   */
+  explicit Journal(const string &file_path);
+  /**
+   * Commits any buffered records and closes the journal file.
+   */
+  ~Journal();
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  /**
+   * Buffers a record to be written on the next commit. The buffer is committed automatically once
+   * it holds a full group of records.
+   *
+   * @param type the type of mutation
+   * @param payload the comma-separated fields of the record
+   */
+  void append(RecordType type, const string &payload);
+  /**
+   * Writes all buffered records to the journal file and fsyncs it.
+   */
+  void commit();
+  /**
+   * Gets the number of records in the journal file, including buffered records.
+   *
+   * @return the number of records since the last compaction
+   */
+  size_t get_record_count() const;
+  /**
+   * Empties the journal after the program state has been saved.
+   */
+  void reset();
+
+  /**
+   * Replays every complete record in the journal file onto the loaded program state. Records that
+   * are already reflected in the state, such as after a crash during compaction, are skipped.
+   *
+   * @param users the Users in the program, which registrations are added to
+   * @param facility the Facility to apply event mutations to
+   */
+  void replay(UserDirectory &users, Facility &facility);
+
+private:
+  string file_path;
+  int fd;
+  string buffer;
+  size_t buffered_records;
+  size_t record_count;
+};
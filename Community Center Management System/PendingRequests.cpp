@@ -0,0 +1,138 @@
+#include "PendingRequests.hpp"
+#include <climits>
+
+using namespace std;
+
+PendingRequests::RequesterType PendingRequests::requester_type(const shared_ptr<User> &requester)
+{
+  if (!requester)
+    return OTHER;
+  switch (requester->get_category())
+  {
+  case User::RESIDENT:
+    return RESIDENT;
+  case User::NONRESIDENT:
+    return NONRESIDENT;
+  case User::CITY:
+    return CITY;
+  case User::ORGANIZATION:
+    return ORGANIZATION;
+  default:
+    return OTHER;
+  }
+}
+
+PendingRequests::Id PendingRequests::insert(const ReservationRequest &request)
+{
+  uint32_t index;
+  if (free_slots.empty())
+  {
+    index = slots.size();
+    slots.push_back(Slot{0, false, OTHER, {}, {}, {}});
+  }
+  else
+  {
+    index = free_slots.back();
+    free_slots.pop_back();
+  }
+
+  Slot &slot = slots[index];
+  slot.generation++;
+  slot.live = true;
+  slot.type = requester_type(request.get_requester());
+  Id id = static_cast<Id>(slot.generation) << 32 | index;
+  long long start = request.get_dt().minutes_since_epoch();
+  slot.entry = requests.insert(requests.end(), Entry{id, request});
+  slot.by_start_entry = by_start.emplace_hint(by_start.end(), start, id);
+  slot.by_requester_entry = by_requester.emplace(make_pair(static_cast<int>(slot.type), start), id);
+  return id;
+}
+
+bool PendingRequests::erase(Id id)
+{
+  if (find_slot(id) == nullptr)
+    return false;
+  uint32_t index = static_cast<uint32_t>(id);
+  Slot &slot = slots[index];
+  requests.erase(slot.entry);
+  by_start.erase(slot.by_start_entry);
+  by_requester.erase(slot.by_requester_entry);
+  slot.live = false;
+  free_slots.push_back(index);
+  return true;
+}
+
+const ReservationRequest *PendingRequests::get(Id id) const
+{
+  const Slot *slot = find_slot(id);
+  return slot == nullptr ? nullptr : &slot->entry->request;
+}
+
+PendingRequests::Id PendingRequests::find(const DateTime &dt) const
+{
+  auto match = by_start.find(dt.minutes_since_epoch());
+  return match == by_start.end() ? NONE : match->second;
+}
+
+vector<PendingRequests::Id> PendingRequests::page(Order order, Id after, size_t count, RequesterType type, bool &more) const
+{
+  vector<Id> ids;
+  more = false;
+  // Adds a request to the page if it matches; returns false once the page is full
+  auto take = [&](Id id)
+  {
+    if (type != ALL && slots[static_cast<uint32_t>(id)].type != type)
+      return true;
+    if (ids.size() == count)
+    {
+      more = true;
+      return false;
+    }
+    ids.push_back(id);
+    return true;
+  };
+
+  const Slot *cursor = find_slot(after);
+  if (order == SUBMITTED)
+  {
+    auto it = cursor ? next(list<Entry>::const_iterator(cursor->entry)) : requests.begin();
+    while (it != requests.end() && take(it->id))
+      ++it;
+  }
+  else if (order == START)
+  {
+    auto it = cursor ? next(cursor->by_start_entry) : by_start.begin();
+    while (it != by_start.end() && take(it->second))
+      ++it;
+  }
+  else
+  {
+    // The requests of one type are contiguous in this order, so a filtered page jumps straight to them
+    auto it = cursor ? next(cursor->by_requester_entry)
+                     : type == ALL ? by_requester.begin() : by_requester.lower_bound(make_pair(static_cast<int>(type), LLONG_MIN));
+    while (it != by_requester.end() && (type == ALL || it->first.first == type) && take(it->second))
+      ++it;
+  }
+  return ids;
+}
+
+void PendingRequests::reserve(size_t count)
+{
+  slots.reserve(count);
+}
+
+size_t PendingRequests::size() const { return requests.size(); }
+
+bool PendingRequests::empty() const { return requests.empty(); }
+
+PendingRequests::const_iterator PendingRequests::begin() const { return const_iterator(requests.begin()); }
+
+PendingRequests::const_iterator PendingRequests::end() const { return const_iterator(requests.end()); }
+
+const PendingRequests::Slot *PendingRequests::find_slot(Id id) const
+{
+  uint32_t index = static_cast<uint32_t>(id);
+  if (index >= slots.size() || !slots[index].live || slots[index].generation != id >> 32)
+    return nullptr;
+  return &slots[index];
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "ReservationRequest.hpp"
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class User;
+
+/**
+ * The ReservationRequests waiting for approval, in the order they were submitted. Each request lives in
+ * a slot map that hands out a stable ID, so it can be looked up and removed in constant time no matter
+ * how many others are waiting. The requests are also indexed by event start and by requester type, and
+ * can be paged through in any of the three orders from the last request shown, so walking the whole
+ * backlog page by page costs time proportional to its size.
+ */
+class PendingRequests
+{
+public:
+  // A slot index in the low 32 bits and the slot's generation in the high 32. Generations start at 1,
+  // so no ID is 0, and a removed request's ID is never handed out again.
+  using Id = uint64_t;
+  static constexpr Id NONE = 0;
+
+  enum Order
+  {
+    SUBMITTED,
+    START,
+    REQUESTER
+  };
+
+  // In the order the Facility's hourly rates rank them, cheapest first
+  enum RequesterType
+  {
+    CITY,
+    RESIDENT,
+    NONRESIDENT,
+    ORGANIZATION,
+    OTHER,
+    ALL // matches every requester when filtering
+  };
+
+private:
+  struct Entry
+  {
+    Id id;
+    ReservationRequest request;
+  };
+
+  struct Slot
+  {
+    uint32_t generation;
+    bool live;
+    RequesterType type;
+    list<Entry>::iterator entry;
+    multimap<long long, Id>::iterator by_start_entry;
+    multimap<pair<int, long long>, Id>::iterator by_requester_entry;
+  };
+
+public:
+  /**
+   * Iterates the requests in submission order.
+   */
+  class const_iterator
+  {
+  public:
+    using iterator_category = forward_iterator_tag;
+    using value_type = ReservationRequest;
+    using difference_type = ptrdiff_t;
+    using pointer = const ReservationRequest *;
+    using reference = const ReservationRequest &;
+
+    explicit const_iterator(list<Entry>::const_iterator it) : it(it) {}
+    reference operator*() const { return it->request; }
+    pointer operator->() const { return &it->request; }
+    const_iterator &operator++()
+    {
+      ++it;
+      return *this;
+    }
+    bool operator==(const const_iterator &other) const { return it == other.it; }
+    bool operator!=(const const_iterator &other) const { return it != other.it; }
+
+  private:
+    list<Entry>::const_iterator it;
+  };
+
+  PendingRequests() = default;
+  // The slots and indexes point into each other, so the requests are never copied
+  PendingRequests(const PendingRequests &other) = delete;
+  PendingRequests(PendingRequests &&other) = default;
+  PendingRequests &operator=(const PendingRequests &other) = delete;
+  PendingRequests &operator=(PendingRequests &&other) = default;
+
+  /**
+   * Gets the type of a requester, used to order and filter the requests.
+   *
+   * @param requester the User making a request
+   * @return the RequesterType, OTHER if the User is neither a Citizen nor a Client
+   */
+  static RequesterType requester_type(const shared_ptr<User> &requester);
+
+  /**
+   * Adds a request after all others.
+   *
+   * @param request the ReservationRequest
+   * @return the ID of the request
+   */
+  Id insert(const ReservationRequest &request);
+  /**
+   * Removes a request.
+   *
+   * @param id the ID of the request
+   * @return was the request waiting
+   */
+  bool erase(Id id);
+  /**
+   * Gets a request.
+   *
+   * @param id the ID of the request
+   * @return the request, or nullptr if it is not waiting
+   */
+  const ReservationRequest *get(Id id) const;
+  /**
+   * Finds the first submitted request for an event starting at the given DateTime.
+   *
+   * @param dt the start of the event
+   * @return the ID of the request, or NONE if there is none
+   */
+  Id find(const DateTime &dt) const;
+  /**
+   * Gets a page of requests in some order, starting after the last request of the previous page.
+   *
+   * @param order the order to page through the requests in
+   * @param after the ID of the last request shown, or NONE (or a removed request's ID) to start from the first
+   * @param count the most requests to return
+   * @param type only return requests from this RequesterType, or ALL
+   * @param more the output of whether more matching requests follow the page
+   * @return the IDs of the requests on the page
+   */
+  vector<Id> page(Order order, Id after, size_t count, RequesterType type, bool &more) const;
+  /**
+   * Reserves room for a number of requests.
+   */
+  void reserve(size_t count);
+
+  size_t size() const;
+  bool empty() const;
+  const_iterator begin() const;
+  const_iterator end() const;
+
+private:
+  list<Entry> requests; // submission order
+  vector<Slot> slots; // ID slot index to the request's place in requests and the indexes
+  vector<uint32_t> free_slots;
+  multimap<long long, Id> by_start; // start minute, ties in submission order
+  multimap<pair<int, long long>, Id> by_requester; // RequesterType then start minute, ties in submission order
+
+  const Slot *find_slot(Id id) const;
+};
@@ -8,7 +8,7 @@ ReservationRequest::ReservationRequest(const DateTime &dt, const Event::LayoutTy
     : dt(dt), layout(layout), guests(guests), is_public(is_public), price_per_ticket(price_per_ticket),
       duration_in_hours(duration), payment(payment), requester(requester) {}
 
-DateTime ReservationRequest::get_dt() const { return dt; }
+const DateTime &ReservationRequest::get_dt() const { return dt; }
 
 string ReservationRequest::get_date() const { return dt.get_date_str(); }
 
@@ -24,14 +24,14 @@ int ReservationRequest::get_price_per_ticket() const { return price_per_ticket;
 
 bool ReservationRequest::get_is_public() const { return is_public; }
 
-Payment ReservationRequest::get_payment() const { return payment; }
+const Payment &ReservationRequest::get_payment() const { return payment; }
 
-shared_ptr<User> ReservationRequest::get_requester() const { return requester; }
+const shared_ptr<User> &ReservationRequest::get_requester() const { return requester; }
 
 Event ReservationRequest::create_event() const
 {
   // By default, the Event host and organizer is the person who requested the event
-  return Event(dt, layout, guests, is_public, price_per_ticket, duration_in_hours, 40, payment, requester);
+  return Event(dt, layout, guests, is_public, price_per_ticket, duration_in_hours, Event::DEFAULT_CAPACITY, payment, requester);
 }
 
 bool ReservationRequest::operator==(const ReservationRequest &other) const
@@ -4,11 +4,12 @@
 #include "Payment.hpp"
 #include "User.hpp"
 #include "DateTime.hpp"
+#include "Versioned.hpp"
 #include <memory>
 
 using namespace std;
 
-class ReservationRequest
+class ReservationRequest : public Versioned
 {
 private:
   DateTime dt;
@@ -31,7 +32,7 @@ public:
    *
    * @return the DateTime
    */
-  DateTime get_dt() const;
+  const DateTime &get_dt() const;
   /**
    * Gets the date of this Event.
    *
@@ -75,11 +76,11 @@ public:
    *
    * @return the Payment
    */
-  Payment get_payment() const;
+  const Payment &get_payment() const;
   /**
    * Gets the requester of this ReservationRequest.
    */
-  shared_ptr<User> get_requester() const;
+  const shared_ptr<User> &get_requester() const;
 
   /**
    * Creates an Event from this ReservationRequest.
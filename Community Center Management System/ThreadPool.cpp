@@ -0,0 +1,81 @@
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(size_t thread_count)
+    : task(nullptr), task_count(0), next_task(0), busy_workers(0), batch(0), stopping(false)
+{
+  for (size_t i = 1; i < thread_count; i++)
+    workers.push_back(thread(&ThreadPool::work, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    lock_guard<mutex> lock(batch_mutex);
+    stopping = true;
+  }
+  batch_ready.notify_all();
+  for (thread &worker : workers)
+    worker.join();
+}
+
+void ThreadPool::run(size_t task_count, const function<void(size_t)> &task)
+{
+  {
+    lock_guard<mutex> lock(batch_mutex);
+    this->task = &task;
+    this->task_count = task_count;
+    next_task = 0;
+    batch++;
+  }
+  batch_ready.notify_all();
+
+  drain(task, task_count);
+
+  // Workers that joined the batch may still be running their last task
+  unique_lock<mutex> lock(batch_mutex);
+  batch_done.wait(lock, [this]
+                  { return busy_workers == 0; });
+  this->task = nullptr;
+}
+
+size_t ThreadPool::get_thread_count() const { return workers.size() + 1; }
+
+void ThreadPool::work()
+{
+  unsigned long seen_batch = 0;
+  while (true)
+  {
+    const function<void(size_t)> *batch_task;
+    size_t batch_size;
+    {
+      unique_lock<mutex> lock(batch_mutex);
+      batch_ready.wait(lock, [this, seen_batch]
+                       { return stopping || batch != seen_batch; });
+      if (stopping)
+        return;
+      // A worker that wakes after its batch has finished joins whichever batch is current
+      seen_batch = batch;
+      if (task == nullptr)
+        continue;
+      batch_task = task;
+      batch_size = task_count;
+      busy_workers++;
+    }
+
+    drain(*batch_task, batch_size);
+
+    {
+      lock_guard<mutex> lock(batch_mutex);
+      busy_workers--;
+    }
+    batch_done.notify_all();
+  }
+}
+
+void ThreadPool::drain(const function<void(size_t)> &batch_task, size_t batch_size)
+{
+  for (size_t i = next_task++; i < batch_size; i = next_task++)
+    batch_task(i);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A fixed set of worker threads that run batches of indexed tasks. The thread that starts a batch
+ * works on it too, and only returns once every task in the batch has finished.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * Starts the worker threads.
+   *
+   * @param thread_count the number of threads to run tasks on, including the calling thread
+   */
+  explicit ThreadPool(size_t thread_count);
+  /**
+   * Stops and joins the worker threads.
+   */
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * Runs task(0) to task(task_count - 1) across the pool, in no particular order.
+   *
+   * @param task_count the number of tasks in the batch
+   * @param task the task to run for each index
+   */
+  void run(size_t task_count, const function<void(size_t)> &task);
+
+  /**
+   * Gets the number of threads that run tasks, including the calling thread.
+   *
+   * @return the thread count
+   */
+  size_t get_thread_count() const;
+
+private:
+  vector<thread> workers;
+  mutex batch_mutex;
+  condition_variable batch_ready;
+  condition_variable batch_done;
+  const function<void(size_t)> *task;
+  size_t task_count;
+  atomic<size_t> next_task;
+  size_t busy_workers;
+  unsigned long batch;
+  bool stopping;
+
+  void work();
+  void drain(const function<void(size_t)> &batch_task, size_t batch_size);
+};
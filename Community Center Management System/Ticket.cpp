@@ -1,11 +1,11 @@
 #include "Ticket.hpp"
 
-Ticket::Ticket(shared_ptr<Citizen> holder, shared_ptr<Event> event)
+Ticket::Ticket(shared_ptr<Citizen> holder, const Event *event)
     : holder(holder), event(event) {}
 
-string Ticket::get_holder_username() const { return holder->get_username(); }
+const string &Ticket::get_holder_username() const { return holder->get_username(); }
 
-shared_ptr<Citizen> Ticket::get_holder() const { return holder; }
+const shared_ptr<Citizen> &Ticket::get_holder() const { return holder; }
 
 bool Ticket::operator==(const Ticket &ticket) const
 {
@@ -27,7 +27,7 @@ ostream &operator<<(ostream &out, const Ticket &t)
   return out;
 }
 
-void Ticket::refund(const int &amount)
+void Ticket::refund(const int &amount) const
 {
   holder->add_to_balance(amount);
   // remove the ticket from the user's list of tickets
@@ -15,26 +15,26 @@ class Ticket
 {
 private:
   shared_ptr<Citizen> holder;
-  shared_ptr<Event> event;
+  const Event *event; // owned by the Facility or the EventArchive, which keep it at one address
 
 public:
-  Ticket(shared_ptr<Citizen> holder, shared_ptr<Event> event);
+  Ticket(shared_ptr<Citizen> holder, const Event *event);
   ~Ticket() = default;
 
   // getters
   /**
    * Gets the username of the holder of this Ticket.
    */
-  string get_holder_username() const;
+  const string &get_holder_username() const;
   /**
    * Gets the holder of this Ticket.
    */
-  shared_ptr<Citizen> get_holder() const;
+  const shared_ptr<Citizen> &get_holder() const;
 
   /**
    * Refunds the ticket to the holder's account
    */
-  void refund(const int &amount);
+  void refund(const int &amount) const;
 
   // overload operators
   bool operator==(const Ticket &ticket) const;
@@ -0,0 +1,61 @@
+#include "TicketHolders.hpp"
+#include "Ticket.hpp"
+
+using namespace std;
+
+TicketHolders::TicketHolders(const TicketHolders &other) : tickets(other.tickets)
+{
+  index();
+}
+
+TicketHolders &TicketHolders::operator=(const TicketHolders &other)
+{
+  tickets = other.tickets;
+  index();
+  return *this;
+}
+
+const Ticket *TicketHolders::find(const Citizen *holder) const
+{
+  auto position = positions.find(holder);
+  return position == positions.end() ? nullptr : &*position->second;
+}
+
+bool TicketHolders::contains(const Citizen *holder) const
+{
+  return positions.count(holder) != 0;
+}
+
+bool TicketHolders::insert(const Ticket &ticket)
+{
+  const Citizen *holder = ticket.get_holder().get();
+  if (positions.count(holder) != 0)
+    return false;
+  positions.emplace(holder, tickets.insert(tickets.end(), ticket));
+  return true;
+}
+
+bool TicketHolders::erase(const Citizen *holder)
+{
+  auto position = positions.find(holder);
+  if (position == positions.end())
+    return false;
+  tickets.erase(position->second);
+  positions.erase(position);
+  return true;
+}
+
+size_t TicketHolders::size() const { return tickets.size(); }
+
+bool TicketHolders::empty() const { return tickets.empty(); }
+
+TicketHolders::const_iterator TicketHolders::begin() const { return tickets.begin(); }
+
+TicketHolders::const_iterator TicketHolders::end() const { return tickets.end(); }
+
+void TicketHolders::index()
+{
+  positions.clear();
+  for (auto it = tickets.begin(); it != tickets.end(); ++it)
+    positions.emplace(it->get_holder().get(), it);
+}
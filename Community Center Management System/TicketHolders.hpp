@@ -0,0 +1,67 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+using namespace std;
+
+class Citizen;
+class Ticket;
+
+/**
+ * The Tickets of an Event, at most one per Citizen, in purchase order. The Tickets are kept in a linked
+ * list with a hash index from each holder to their Ticket, so checking, adding and removing a holder
+ * take constant time while iteration still follows purchase order.
+ */
+class TicketHolders
+{
+public:
+  using const_iterator = list<Ticket>::const_iterator;
+
+  TicketHolders() = default;
+  // The index points into the list, so a copy rebuilds it; a move keeps the list nodes and so the index
+  TicketHolders(const TicketHolders &other);
+  TicketHolders(TicketHolders &&other) = default;
+  TicketHolders &operator=(const TicketHolders &other);
+  TicketHolders &operator=(TicketHolders &&other) = default;
+
+  /**
+   * Finds the Ticket held by a Citizen.
+   *
+   * @param holder the Citizen
+   * @return the Ticket, or nullptr if the Citizen holds none
+   */
+  const Ticket *find(const Citizen *holder) const;
+  /**
+   * Does a Citizen hold a Ticket?
+   *
+   * @param holder the Citizen
+   * @return does the Citizen hold a Ticket
+   */
+  bool contains(const Citizen *holder) const;
+  /**
+   * Adds a Ticket after all others, unless its holder already holds one.
+   *
+   * @param ticket the Ticket
+   * @return was the Ticket added
+   */
+  bool insert(const Ticket &ticket);
+  /**
+   * Removes the Ticket held by a Citizen, if any.
+   *
+   * @param holder the Citizen
+   * @return was a Ticket removed
+   */
+  bool erase(const Citizen *holder);
+
+  size_t size() const;
+  bool empty() const;
+  const_iterator begin() const;
+  const_iterator end() const;
+
+private:
+  list<Ticket> tickets; // purchase order
+  unordered_map<const Citizen *, list<Ticket>::iterator> positions; // holder to their Ticket in tickets
+
+  void index();
+};
@@ -1,8 +1,11 @@
 #include "User.hpp"
+#include "Event.hpp"
+#include <algorithm>
 
-User::User(const string &username, const string &password) : username(username), password(password), balance(0) {}
+User::User(const string &username, const string &password, Category category)
+    : username(username), password(password), balance(0), category(category), booked_hours(0) {}
 
-string User::get_username() const
+const string &User::get_username() const
 {
   return username;
 }
@@ -12,6 +15,58 @@ string User::get_password() const
   return password;
 }
 
+User::Category User::get_category() const
+{
+  return category;
+}
+
+bool User::is_citizen() const
+{
+  return category == RESIDENT || category == NONRESIDENT;
+}
+
+bool User::is_client() const
+{
+  return category == CITY || category == ORGANIZATION;
+}
+
+int User::get_booked_hours() const
+{
+  return booked_hours;
+}
+
+void User::set_booked_hours(const int &booked_hours)
+{
+  this->booked_hours = booked_hours;
+}
+
+void User::add_event(const shared_ptr<Event> &event)
+{
+  my_events.push_back(event);
+}
+
+void User::remove_event(const Event &event)
+{
+  my_events.erase(remove_if(my_events.begin(), my_events.end(), [&event](const shared_ptr<Event> &mine)
+                           { return mine.get() == &event; }),
+                  my_events.end());
+}
+
+const vector<shared_ptr<Event>> &User::get_my_events() const
+{
+  return my_events;
+}
+
+void User::display_my_events()
+{
+  cout << "My reserved events: " << endl;
+  if (my_events.size() == 0)
+    cout << "No reserved events." << endl;
+  else
+    for (const shared_ptr<Event> &event : my_events)
+      cout << *event << endl;
+}
+
 void User::claim_balance()
 {
   if (balance > 0)
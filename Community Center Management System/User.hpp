@@ -1,26 +1,88 @@
 #pragma once
 
+#include "Versioned.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
+#include <memory>
 
 using namespace std;
 
 class Facility;
+class Event;
 
-class User
+class User : public enable_shared_from_this<User>, public Versioned
 {
+public:
+  /**
+   * What kind of User this is, so callers can switch on it instead of casting to a subclass.
+   */
+  enum Category
+  {
+    RESIDENT,    // a resident Citizen
+    NONRESIDENT, // a non-resident Citizen
+    CITY,        // a city Client
+    ORGANIZATION, // an organization Client
+    MANAGER,     // the FacilityManager
+    CATEGORY_COUNT
+  };
+
 private:
   string username; // must be unique
   string password;
   double balance;
+  Category category;
+  vector<shared_ptr<Event>> my_events; // events that the user has successfully reserved
+  int booked_hours;
 
 public:
-  User(const string &username, const string &password);
+  User(const string &username, const string &password, Category category);
   virtual ~User() = default;
 
-  string get_username() const;
+  const string &get_username() const;
   string get_password() const;
+  /**
+   * Gets the Category of this User.
+   *
+   * @return the Category
+   */
+  Category get_category() const;
+  /**
+   * Is this User a Citizen?
+   */
+  bool is_citizen() const;
+  /**
+   * Is this User a Client?
+   */
+  bool is_client() const;
+  /**
+   * Gets the number of booked hours from this User.
+   *
+   * @return the number of booked hours from this User
+   */
+  int get_booked_hours() const;
+  /**
+   * Sets the number of booked hours for this User.
+   *
+   * @param booked_hours the new number of booked hours
+   */
+  void set_booked_hours(const int &booked_hours);
+  /**
+   * Adds an Event to this User's list of events.
+   */
+  void add_event(const shared_ptr<Event> &event);
+  /**
+   * Removes an Event from this User's list of events. The Event is matched by identity, not by value.
+   */
+  void remove_event(const Event &event);
+  /**
+   * Gets the Events that this User has created.
+   */
+  const vector<shared_ptr<Event>> &get_my_events() const;
+  /**
+   * Displays the Events that this User has created.
+   */
+  virtual void display_my_events();
   /**
    * Prompts the user to claim their balance if they have any.
    */
@@ -0,0 +1,85 @@
+#include "UserDirectory.hpp"
+
+using namespace std;
+
+UserDirectory::UserDirectory() : slots(16, Slot{0, EMPTY}) {}
+
+bool UserDirectory::add(const shared_ptr<User> &user)
+{
+  uint32_t hash = hash_username(user->get_username());
+  size_t slot = find_slot(user->get_username(), hash);
+  if (slots[slot].user != EMPTY)
+    return false;
+
+  slots[slot] = Slot{hash, static_cast<uint32_t>(users.size())};
+  users.push_back(user);
+  if (users.size() * 2 > slots.size())
+    rehash(slots.size() * 2);
+  return true;
+}
+
+shared_ptr<User> UserDirectory::find(string_view username) const
+{
+  size_t index = index_of(username);
+  return index == users.size() ? nullptr : users[index];
+}
+
+size_t UserDirectory::index_of(string_view username) const
+{
+  uint32_t user = slots[find_slot(username, hash_username(username))].user;
+  return user == EMPTY ? users.size() : user;
+}
+
+bool UserDirectory::contains(string_view username) const { return index_of(username) != users.size(); }
+
+void UserDirectory::reserve(size_t count)
+{
+  users.reserve(count);
+  size_t capacity = slots.size();
+  while (count * 2 > capacity)
+    capacity *= 2;
+  if (capacity != slots.size())
+    rehash(capacity);
+}
+
+const vector<shared_ptr<User>> &UserDirectory::get_users() const { return users; }
+
+size_t UserDirectory::size() const { return users.size(); }
+
+uint32_t UserDirectory::hash_username(string_view username)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (char c : username)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+size_t UserDirectory::find_slot(string_view username, uint32_t hash) const
+{
+  // Linear probing; the table is never full, so an empty slot ends every probe
+  size_t mask = slots.size() - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+  {
+    const Slot &candidate = slots[slot];
+    if (candidate.user == EMPTY || (candidate.hash == hash && users[candidate.user]->get_username() == username))
+      return slot;
+  }
+}
+
+void UserDirectory::rehash(size_t capacity)
+{
+  slots.assign(capacity, Slot{0, EMPTY});
+  size_t mask = capacity - 1;
+  for (size_t i = 0; i < users.size(); i++)
+  {
+    uint32_t hash = hash_username(users[i]->get_username());
+    size_t slot = hash & mask;
+    while (slots[slot].user != EMPTY)
+      slot = (slot + 1) & mask;
+    slots[slot] = Slot{hash, static_cast<uint32_t>(i)};
+  }
+}
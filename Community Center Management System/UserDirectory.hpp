@@ -0,0 +1,82 @@
+#pragma once
+
+#include "User.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+/**
+ * All registered Users, in registration order, indexed by username. Lookups go through an open
+ * addressing hash table of user indexes; the usernames themselves are only stored once, in the Users.
+ */
+class UserDirectory
+{
+public:
+  UserDirectory();
+
+  /**
+   * Adds a User, unless their username is already taken.
+   *
+   * @param user the User to add
+   * @return was the User added
+   */
+  bool add(const shared_ptr<User> &user);
+  /**
+   * Finds a User by username.
+   *
+   * @param username the User's username
+   * @return the User, or nullptr if the User doesn't exist
+   */
+  shared_ptr<User> find(string_view username) const;
+  /**
+   * Finds the position of a User in registration order.
+   *
+   * @param username the User's username
+   * @return the User's index, or size() if the User doesn't exist
+   */
+  size_t index_of(string_view username) const;
+  /**
+   * Is the username taken?
+   *
+   * @param username the username
+   * @return does a User with this username exist
+   */
+  bool contains(string_view username) const;
+  /**
+   * Makes room for the given number of Users without rehashing.
+   *
+   * @param count the number of Users
+   */
+  void reserve(size_t count);
+
+  /**
+   * Gets all Users in registration order.
+   *
+   * @return the Users
+   */
+  const vector<shared_ptr<User>> &get_users() const;
+  /**
+   * Gets the number of Users.
+   *
+   * @return the number of Users
+   */
+  size_t size() const;
+
+private:
+  struct Slot
+  {
+    uint32_t hash;
+    uint32_t user; // index into users, or EMPTY
+  };
+  static constexpr uint32_t EMPTY = UINT32_MAX;
+
+  vector<shared_ptr<User>> users;
+  vector<Slot> slots; // the capacity is a power of two, at most half full
+
+  static uint32_t hash_username(string_view username);
+  size_t find_slot(string_view username, uint32_t hash) const;
+  void rehash(size_t capacity);
+};
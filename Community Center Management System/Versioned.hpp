@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+
+using namespace std;
+
+/**
+ * A version stamp for records that are saved incrementally. Every change to a record gives it a fresh
+ * stamp from a global counter, so a saved copy of a record is up to date exactly when the stamp it was
+ * saved with equals the record's current stamp. The counter is atomic, since records are created on
+ * several threads while loading.
+ */
+class Versioned
+{
+private:
+  unsigned long version;
+  inline static atomic<unsigned long> next_version{0};
+
+protected:
+  Versioned() : version(++next_version) {}
+  Versioned(const Versioned &) = default;
+  Versioned &operator=(const Versioned &) = default;
+  ~Versioned() = default;
+
+  /**
+   * Marks this record as changed.
+   */
+  void touch() { version = ++next_version; }
+
+public:
+  /**
+   * Gets the version stamp of this record.
+   *
+   * @return the version stamp, which changes whenever the record does
+   */
+  unsigned long get_version() const { return version; }
+};
@@ -0,0 +1,110 @@
+#include "Waitlist.hpp"
+#include "Citizen.hpp"
+
+using namespace std;
+
+namespace
+{
+  const size_t MIN_JOINS = 64; // join numbers kept before the queue is renumbered
+
+  size_t lowest_bit(size_t i) { return i & (~i + 1); }
+}
+
+Waitlist::Waitlist() : waiting(1, 0) {}
+
+Waitlist::Waitlist(const Waitlist &other) : queue(other.queue)
+{
+  index();
+}
+
+Waitlist &Waitlist::operator=(const Waitlist &other)
+{
+  queue = other.queue;
+  index();
+  return *this;
+}
+
+bool Waitlist::push(const shared_ptr<Citizen> &citizen)
+{
+  if (places.count(citizen.get()) != 0)
+    return false;
+
+  // Renumber once most join numbers belong to Citizens who already left, so the tree stays proportional to the line
+  if (waiting.size() > MIN_JOINS && waiting.size() > 2 * queue.size())
+    index();
+
+  // Append a tree node for the new join number: it covers the join numbers since its lowest set bit
+  size_t joined = waiting.size();
+  uint32_t covered = 1;
+  for (size_t i = joined - 1; i > joined - lowest_bit(joined); i -= lowest_bit(i))
+    covered += waiting[i];
+  waiting.push_back(covered);
+  places.emplace(citizen.get(), Place{queue.insert(queue.end(), citizen), joined});
+  return true;
+}
+
+shared_ptr<Citizen> Waitlist::pop()
+{
+  if (queue.empty())
+    return nullptr;
+  shared_ptr<Citizen> citizen = queue.front();
+  leave(places.find(citizen.get()));
+  return citizen;
+}
+
+bool Waitlist::erase(const Citizen *citizen)
+{
+  auto place = places.find(citizen);
+  if (place == places.end())
+    return false;
+  leave(place);
+  return true;
+}
+
+bool Waitlist::contains(const Citizen *citizen) const
+{
+  return places.count(citizen) != 0;
+}
+
+size_t Waitlist::position(const Citizen *citizen) const
+{
+  auto place = places.find(citizen);
+  if (place == places.end())
+    return 0;
+
+  // Everyone who joined up to and including the Citizen and is still waiting
+  size_t ahead = 0;
+  for (size_t i = place->second.joined; i > 0; i -= lowest_bit(i))
+    ahead += waiting[i];
+  return ahead;
+}
+
+size_t Waitlist::size() const { return queue.size(); }
+
+bool Waitlist::empty() const { return queue.empty(); }
+
+Waitlist::const_iterator Waitlist::begin() const { return queue.begin(); }
+
+Waitlist::const_iterator Waitlist::end() const { return queue.end(); }
+
+void Waitlist::leave(unordered_map<const Citizen *, Place>::iterator place)
+{
+  for (size_t i = place->second.joined; i < waiting.size(); i += lowest_bit(i))
+    waiting[i]--;
+  queue.erase(place->second.entry);
+  places.erase(place);
+}
+
+void Waitlist::index()
+{
+  // Number the line from 1; with every join number still waiting, each tree node counts the whole range it covers
+  places.clear();
+  waiting.assign(queue.size() + 1, 0);
+  size_t joined = 0;
+  for (auto it = queue.begin(); it != queue.end(); ++it)
+  {
+    joined++;
+    waiting[joined] = lowest_bit(joined);
+    places.emplace(it->get(), Place{it, joined});
+  }
+}
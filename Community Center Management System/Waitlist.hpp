@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+class Citizen;
+
+/**
+ * The Citizens waiting for a seat at a sold out Event, at most once each, in the order they joined. The
+ * queue is a linked list with a hash index from each Citizen to their place in it, so joining, leaving
+ * from the front and withdrawing from anywhere take constant time. Each place also records when the
+ * Citizen joined, and a Fenwick tree over those join numbers counts who is still waiting ahead of
+ * them, so finding a Citizen's position takes logarithmic time.
+ */
+class Waitlist
+{
+public:
+  using const_iterator = list<shared_ptr<Citizen>>::const_iterator;
+
+  Waitlist();
+  // The index points into the list, so a copy rebuilds it; a move keeps the list nodes and so the index
+  Waitlist(const Waitlist &other);
+  Waitlist(Waitlist &&other) = default;
+  Waitlist &operator=(const Waitlist &other);
+  Waitlist &operator=(Waitlist &&other) = default;
+
+  /**
+   * Adds a Citizen to the back of the line, unless they are already waiting.
+   *
+   * @param citizen the Citizen
+   * @return was the Citizen added
+   */
+  bool push(const shared_ptr<Citizen> &citizen);
+  /**
+   * Removes the Citizen at the front of the line.
+   *
+   * @return the Citizen, or nullptr if nobody is waiting
+   */
+  shared_ptr<Citizen> pop();
+  /**
+   * Removes a Citizen from wherever they are in line.
+   *
+   * @param citizen the Citizen
+   * @return was the Citizen waiting
+   */
+  bool erase(const Citizen *citizen);
+  /**
+   * Is a Citizen waiting?
+   *
+   * @param citizen the Citizen
+   * @return is the Citizen waiting
+   */
+  bool contains(const Citizen *citizen) const;
+  /**
+   * Gets a Citizen's place in line.
+   *
+   * @param citizen the Citizen
+   * @return 1 for the front of the line, or 0 if the Citizen is not waiting
+   */
+  size_t position(const Citizen *citizen) const;
+
+  size_t size() const;
+  bool empty() const;
+  const_iterator begin() const;
+  const_iterator end() const;
+
+private:
+  struct Place
+  {
+    list<shared_ptr<Citizen>>::iterator entry;
+    size_t joined; // join number, 1-based, in waiting
+  };
+
+  list<shared_ptr<Citizen>> queue;              // front of the line first
+  unordered_map<const Citizen *, Place> places; // Citizen to their place in queue
+  vector<uint32_t> waiting;                     // Fenwick tree: is each join number still waiting, index 0 unused
+
+  void leave(unordered_map<const Citizen *, Place>::iterator place);
+  void index();
+};
@@ -13,9 +13,72 @@
 #include <sstream>
 #include <memory>
 #include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
+namespace
+{
+  const char *TEMP_SUFFIX = ".tmp";
+  const char *BATCH_COMMIT_PATH = "program_data/save.commit"; // lists the files of a committed WriteBatch
+  const string_view COMMIT_MARK = "COMMIT\n";                 // ends a complete commit record
+
+  string join_lines(const vector<string> &content)
+  {
+    size_t size = 0;
+    for (const string &line : content)
+      size += line.size() + 1;
+
+    string joined;
+    joined.reserve(size);
+    for (const string &line : content)
+    {
+      joined += line;
+      joined += '\n';
+    }
+    return joined;
+  }
+
+  // Writes a whole file with a single buffered write and fsyncs it
+  bool write_durably(const string &file_path, string_view content)
+  {
+    int fd = open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+      return false;
+
+    const char *data = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0)
+    {
+      ssize_t written = write(fd, data, remaining);
+      if (written < 0)
+        break;
+      data += written;
+      remaining -= written;
+    }
+    bool ok = remaining == 0 && fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+  }
+
+  // Makes renames and unlinks in a file's directory durable
+  void sync_parent_directory(const string &file_path)
+  {
+    size_t slash = file_path.rfind('/');
+    string directory = slash == string::npos ? "." : file_path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0)
+    {
+      fsync(fd);
+      close(fd);
+    }
+  }
+}
+
 namespace fileio
 {
   vector<string> parse_file(const string &file_path)
@@ -40,19 +103,77 @@ namespace fileio
     return file_content;
   }
 
+  bool replace_file(const string &file_path, string_view content)
+  {
+    string temp_path = file_path + TEMP_SUFFIX;
+    if (!write_durably(temp_path, content) || rename(temp_path.c_str(), file_path.c_str()) != 0)
+    {
+      cout << "Error write to file: " << file_path << endl;
+      return false;
+    }
+    sync_parent_directory(file_path);
+    return true;
+  }
+
   void write_to_file(const string &file_path, const vector<string> &content)
   {
-    ofstream outfile(file_path);
+    replace_file(file_path, join_lines(content));
+  }
 
-    if (!outfile.is_open())
-      cout << "Error write to file: " << file_path << endl;
-    else
+  void WriteBatch::add(const string &file_path, const vector<string> &content)
+  {
+    files.push_back(make_pair(file_path, join_lines(content)));
+  }
+
+  bool WriteBatch::commit()
+  {
+    // Write every file beside its target, then record the batch as committed
+    string commit_record;
+    for (const auto &file : files)
+    {
+      if (!write_durably(file.first + TEMP_SUFFIX, file.second))
+      {
+        cout << "Error write to file: " << file.first << endl;
+        return false;
+      }
+      commit_record += file.first + "\n";
+    }
+    commit_record += COMMIT_MARK;
+    if (!write_durably(BATCH_COMMIT_PATH, commit_record))
     {
-      for (const string &line : content)
-        outfile << line << endl;
+      cout << "Error write to file: " << BATCH_COMMIT_PATH << endl;
+      return false;
+    }
+    sync_parent_directory(BATCH_COMMIT_PATH);
 
-      outfile.close();
+    recover_write_batch();
+    files.clear();
+    return true;
+  }
+
+  void recover_write_batch()
+  {
+    if (access(BATCH_COMMIT_PATH, F_OK) != 0)
+      return;
+    MappedFile commit_record(BATCH_COMMIT_PATH);
+    string_view content = commit_record.content();
+
+    // A torn commit record means the batch never committed, and its temporary files are ignored
+    if (content.size() >= COMMIT_MARK.size() && content.substr(content.size() - COMMIT_MARK.size()) == COMMIT_MARK)
+    {
+      content.remove_suffix(COMMIT_MARK.size());
+      string_view line;
+      while (next_line(content, line))
+      {
+        string file_path(line);
+        string temp_path = file_path + TEMP_SUFFIX;
+        if (access(temp_path.c_str(), F_OK) == 0 && rename(temp_path.c_str(), file_path.c_str()) != 0)
+          cout << "Error write to file: " << file_path << endl;
+      }
+      sync_parent_directory(BATCH_COMMIT_PATH);
     }
+    unlink(BATCH_COMMIT_PATH);
+    sync_parent_directory(BATCH_COMMIT_PATH);
   }
 
   void sanitize_lines(string &str)
@@ -60,88 +181,318 @@ namespace fileio
     str.erase(remove(str.begin(), str.end(), '\r'), str.end()); // deletes CR
     str.erase(remove(str.begin(), str.end(), '\n'), str.end()); // deletes LF
   }
+
+  MappedFile::MappedFile(const string &file_path) : data(nullptr), size(0)
+  {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      cout << "Error reading file: " << file_path << endl;
+      cout << "Default to empty content." << endl;
+      return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED)
+      {
+        madvise(mapped, st.st_size, MADV_SEQUENTIAL);
+        data = static_cast<const char *>(mapped);
+        size = st.st_size;
+      }
+      else
+        cout << "Error mapping file: " << file_path << endl;
+    }
+    close(fd); // the mapping stays valid after the descriptor is closed
+  }
+
+  MappedFile::~MappedFile()
+  {
+    if (data != nullptr)
+      munmap(const_cast<char *>(data), size);
+  }
+
+  string_view MappedFile::content() const { return string_view(data, size); }
+
+  void MappedFile::discard_before(const char *position) const
+  {
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t length = (position - data) / page_size * page_size;
+    if (data != nullptr && length > 0)
+      madvise(const_cast<char *>(data), length, MADV_DONTNEED);
+  }
+
+  bool next_line(string_view &content, string_view &line)
+  {
+    if (content.empty())
+      return false;
+
+    size_t end = content.find('\n');
+    if (end == string_view::npos)
+    {
+      line = content;
+      content = string_view();
+    }
+    else
+    {
+      line = content.substr(0, end);
+      content.remove_prefix(end + 1);
+    }
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+    return true;
+  }
+
+  string_view next_field(string_view &line, char sep)
+  {
+    size_t end = line.find(sep);
+    string_view field = line.substr(0, end);
+    if (end == string_view::npos)
+      line = string_view();
+    else
+      line.remove_prefix(end + 1);
+    return field;
+  }
+
+  size_t split_fields(string_view line, char sep, string_view *fields, size_t max_fields)
+  {
+    size_t count = 0;
+    while (count < max_fields && !line.empty())
+      fields[count++] = next_field(line, sep);
+    for (size_t i = count; i < max_fields; i++)
+      fields[i] = string_view();
+    return count;
+  }
+
+  int to_int(string_view s)
+  {
+    int value = 0;
+    from_chars(s.data(), s.data() + s.size(), value);
+    return value;
+  }
+
+  long to_long(string_view s)
+  {
+    long value = 0;
+    from_chars(s.data(), s.data() + s.size(), value);
+    return value;
+  }
+
+  double to_double(string_view s)
+  {
+    double value = 0;
+    from_chars(s.data(), s.data() + s.size(), value);
+    return value;
+  }
 }
 
 namespace user_utils
 {
-  vector<shared_ptr<User>> load_saved_users()
+  shared_ptr<User> csv_to_user(string_view line)
   {
-    vector<shared_ptr<User>> users;
-
-    vector<string> user_strings = fileio::parse_file("program_data/users.csv");
-    for (const string &user_str : user_strings)
+    // Read user type, username, password and user status
+    string_view fields[4];
+    fileio::split_fields(line, ',', fields, 4);
+    string_view user_type_str = fields[0];
+    string user_name(fields[1]);
+    string user_password(fields[2]);
+    string_view user_type_status_str = fields[3];
+
+    if (user_type_str == "FACILITY_MANAGER")
+      return make_shared<FacilityManager>(user_name, user_password);
+    if (user_type_str == "CITIZEN")
     {
-      stringstream ss(user_str);
-      string item;
-      char token = ',';
-
-      string user_type_str;
-      string user_name;
-      string user_password;
-      string user_type_status_str = "";
+      auto type = user_type_status_str == "RESIDENT" ? Citizen::RESIDENT : Citizen::NONRESIDENT;
+      return make_shared<Citizen>(user_name, user_password, type);
+    }
+    auto type = user_type_status_str == "CITY" ? Client::CITY : Client::ORGANIZATION;
+    return make_shared<Client>(user_name, user_password, type);
+  }
 
-      // Read user type, first name, last name
-      getline(ss, user_type_str, token);
-      getline(ss, user_name, token);
-      getline(ss, user_password, token);
+  string user_to_csv(const shared_ptr<User> &user_ptr)
+  {
+    string credentials = user_ptr->get_username() + "," + user_ptr->get_password();
+    switch (user_ptr->get_category())
+    {
+    case User::RESIDENT:
+      return "CITIZEN," + credentials + ",RESIDENT";
+    case User::NONRESIDENT:
+      return "CITIZEN," + credentials + ",NON_RESIDENT";
+    case User::CITY:
+      return "CLIENT," + credentials + ",CITY";
+    case User::ORGANIZATION:
+      return "CLIENT," + credentials + ",ORGANIZATION";
+    default:
+      return "FACILITY_MANAGER," + credentials;
+    }
+  }
 
-      if (user_type_str == "FACILITY_MANAGER")
-      {
-        users.push_back(make_shared<FacilityManager>(user_name, user_password));
-      }
-      else
-      {
-        // Read user status
-        getline(ss, user_type_status_str, token);
+  UserDirectory load_saved_users()
+  {
+    UserDirectory users;
 
-        if (user_type_str == "CITIZEN")
-        {
-          auto type = user_type_status_str == "RESIDENT" ? Citizen::RESIDENT : Citizen::NONRESIDENT;
-          users.push_back(make_shared<Citizen>(user_name, user_password, type));
-        }
-        else
-        {
-          auto type = user_type_status_str == "CITY" ? Client::CITY : Client::ORGANIZATION;
-          users.push_back(make_shared<Client>(user_name, user_password, type));
-        }
-      }
+    fileio::MappedFile file("program_data/users.csv");
+    string_view content = file.content();
+    string_view line;
+    while (fileio::next_line(content, line))
+    {
+      if (!line.empty())
+        users.add(csv_to_user(line));
     }
 
     return users;
   }
 
-  void save_users(const vector<shared_ptr<User>> &users)
+  void save_users(const vector<shared_ptr<User>> &users, fileio::WriteBatch *batch)
   {
     vector<string> user_strings;
 
     for (const auto &user_ptr : users)
-    {
-      if (auto casted_user_ptr = dynamic_pointer_cast<FacilityManager>(user_ptr))
-        user_strings.push_back("FACILITY_MANAGER," + casted_user_ptr->get_username() + "," + casted_user_ptr->get_password());
-      else if (auto casted_user_ptr = dynamic_pointer_cast<Citizen>(user_ptr))
-        user_strings.push_back("CITIZEN," + casted_user_ptr->get_username() + "," + casted_user_ptr->get_password() + "," + (casted_user_ptr->get_resident_status() == Citizen::RESIDENT ? "RESIDENT" : "NON_RESIDENT"));
-      else if (auto casted_user_ptr = dynamic_pointer_cast<Client>(user_ptr))
-        user_strings.push_back("CLIENT," + casted_user_ptr->get_username() + "," + casted_user_ptr->get_password() + "," + (casted_user_ptr->get_client_type() == Client::CITY ? "CITY" : "ORGANIZATION"));
-    }
+      user_strings.push_back(user_to_csv(user_ptr));
 
-    fileio::write_to_file("program_data/users.csv", user_strings);
+    if (batch != nullptr)
+      batch->add("program_data/users.csv", user_strings);
+    else
+      fileio::write_to_file("program_data/users.csv", user_strings);
   }
+}
 
-  shared_ptr<User> username_to_user(const vector<shared_ptr<User>> users, const string &s)
+namespace
+{
+  const size_t DISCARD_INTERVAL = 1 << 20; // bytes read between dropping pages while streaming
+
+  /**
+   * Calls on_header with the header line of a file and then on_line for each non-empty line after it,
+   * dropping the pages that have been read as it goes.
+   */
+  size_t for_each_data_line(const string &file_path, const function<void(string_view)> &on_header,
+                            const function<bool(string_view)> &on_line)
   {
-    for (const shared_ptr<User> &user : users)
+    fileio::MappedFile file(file_path);
+    string_view content = file.content();
+    const char *discarded = content.data();
+    size_t count = 0;
+
+    string_view line;
+    fileio::next_line(content, line);
+    on_header(line);
+    while (fileio::next_line(content, line))
     {
-      if (user->get_username() == s)
-        return user;
+      if (line.empty())
+        continue;
+      count++;
+      if (!on_line(line))
+        break;
+      if (size_t(content.data() - discarded) >= DISCARD_INTERVAL)
+      {
+        file.discard_before(content.data());
+        discarded = content.data();
+      }
     }
+    return count;
+  }
+
+  using event_utils::EventRow;
+  using event_utils::EventSchema;
+
+  const size_t MAX_EVENT_COLUMNS = 32; // columns past this are ignored
+  const char *EVENT_COLUMN_NAMES[EventSchema::COLUMN_COUNT] = {
+      "DATE", "TIME", "LAYOUT", "GUEST_TYPE", "IS_PUBLIC", "PRICE", "DURATION", "CAPACITY", "PAYMENT_AMOUNT",
+      "CC", "CVV", "EXPIRY", "ORGANIZER", "TICKETS", "WAITLIST"};
+  const EventSchema::Column COLUMNS_WITHOUT_CAPACITY[] = {
+      EventSchema::DATE, EventSchema::TIME, EventSchema::LAYOUT, EventSchema::GUEST_TYPE, EventSchema::IS_PUBLIC,
+      EventSchema::PRICE, EventSchema::DURATION, EventSchema::PAYMENT_AMOUNT, EventSchema::CC, EventSchema::CVV,
+      EventSchema::EXPIRY, EventSchema::ORGANIZER, EventSchema::TICKETS, EventSchema::WAITLIST};
+  const EventSchema::Column COLUMNS_WITH_CAPACITY[] = {
+      EventSchema::DATE, EventSchema::TIME, EventSchema::LAYOUT, EventSchema::GUEST_TYPE, EventSchema::IS_PUBLIC,
+      EventSchema::PRICE, EventSchema::DURATION, EventSchema::CAPACITY, EventSchema::PAYMENT_AMOUNT, EventSchema::CC,
+      EventSchema::CVV, EventSchema::EXPIRY, EventSchema::ORGANIZER, EventSchema::TICKETS, EventSchema::WAITLIST};
+
+  EventSchema fixed_schema(EventSchema::Layout layout, const EventSchema::Column *order, size_t width)
+  {
+    EventSchema schema;
+    schema.layout = layout;
+    fill(begin(schema.positions), end(schema.positions), -1);
+    for (size_t i = 0; i < width; i++)
+      schema.positions[order[i]] = i;
+    schema.width = width;
+    return schema;
+  }
+
+  /**
+   * Are the columns of the schema the given columns in order? The trailing columns may be missing,
+   * like the ticket and waitlist columns of pending_events.csv.
+   */
+  bool matches_order(const EventSchema &schema, const EventSchema::Column *order, size_t width)
+  {
+    if (schema.width > width)
+      return false;
+    EventSchema expected = fixed_schema(EventSchema::MAPPED, order, schema.width);
+    return equal(begin(schema.positions), end(schema.positions), begin(expected.positions));
+  }
+
+  int to_capacity(string_view s)
+  {
+    return s.empty() ? Event::DEFAULT_CAPACITY : fileio::to_int(s);
+  }
 
-    return nullptr;
+  /**
+   * Parses a line whose columns are in one of the orders this program writes. The positions are
+   * known at compile time, so this costs no more than parsing a fixed format.
+   */
+  template <bool WITH_CAPACITY>
+  EventRow csv_to_event_row_in_order(string_view line)
+  {
+    // DATE,TIME,LAYOUT,GUEST_TYPE,IS_PUBLIC,PRICE,DURATION,[CAPACITY,]PAYMENT_AMOUNT,CC,CVV,EXPIRY,ORGANIZER[,TICKETS,WAITLIST]
+    constexpr size_t shift = WITH_CAPACITY ? 1 : 0;
+    string_view fields[14 + shift];
+    fileio::split_fields(line, ',', fields, 14 + shift);
+
+    // Transform data from strings to appropriate types
+    return EventRow{DateTime(fields[0], fields[1]),
+                    event_utils::str_to_layout_type(fields[2]),
+                    event_utils::str_to_guest_type(fields[3]),
+                    event_utils::str_to_is_public(fields[4]),
+                    fileio::to_int(fields[5]),
+                    fileio::to_int(fields[6]),
+                    WITH_CAPACITY ? to_capacity(fields[7]) : Event::DEFAULT_CAPACITY,
+                    Payment(fileio::to_double(fields[7 + shift]), fileio::to_long(fields[8 + shift]),
+                            fileio::to_int(fields[9 + shift]), string(fields[10 + shift])),
+                    fields[11 + shift],
+                    fields[12 + shift],
+                    fields[13 + shift]};
+  }
+
+  EventRow csv_to_event_row_mapped(string_view line, const EventSchema &schema)
+  {
+    string_view fields[MAX_EVENT_COLUMNS + 1]; // the last one stays empty, for missing columns
+    fileio::split_fields(line, ',', fields, schema.width);
+    auto field = [&](EventSchema::Column column)
+    {
+      int position = schema.positions[column];
+      return fields[position < 0 ? MAX_EVENT_COLUMNS : position];
+    };
+
+    return EventRow{DateTime(field(EventSchema::DATE), field(EventSchema::TIME)),
+                    event_utils::str_to_layout_type(field(EventSchema::LAYOUT)),
+                    event_utils::str_to_guest_type(field(EventSchema::GUEST_TYPE)),
+                    event_utils::str_to_is_public(field(EventSchema::IS_PUBLIC)),
+                    fileio::to_int(field(EventSchema::PRICE)),
+                    fileio::to_int(field(EventSchema::DURATION)),
+                    to_capacity(field(EventSchema::CAPACITY)),
+                    Payment(fileio::to_double(field(EventSchema::PAYMENT_AMOUNT)), fileio::to_long(field(EventSchema::CC)),
+                            fileio::to_int(field(EventSchema::CVV)), string(field(EventSchema::EXPIRY))),
+                    field(EventSchema::ORGANIZER),
+                    field(EventSchema::TICKETS),
+                    field(EventSchema::WAITLIST)};
   }
 }
 
 namespace event_utils
 {
-  Event::LayoutType str_to_layout_type(const string &s)
+  Event::LayoutType str_to_layout_type(string_view s)
   {
     return s == "WEDDING"   ? Event::WEDDING
            : s == "MEETING" ? Event::MEETING
@@ -149,14 +500,14 @@ namespace event_utils
                             : Event::DANCEROOM;
   }
 
-  Event::GuestType str_to_guest_type(const string &s)
+  Event::GuestType str_to_guest_type(string_view s)
   {
     return s == "RESIDENTS"      ? Event::RESIDENTS
            : s == "NONRESIDENTS" ? Event::NONRESIDENTS
                                  : Event::BOTH;
   }
 
-  bool str_to_is_public(const string &s)
+  bool str_to_is_public(string_view s)
   {
     return s == "public";
   }
@@ -176,209 +527,217 @@ namespace event_utils
                                               : "BOTH";
   }
 
-  vector<Event> load_confirmed_events(const vector<shared_ptr<User>> &users)
+  void load_attendees(Event &event, const vector<shared_ptr<Citizen>> &ticket_holders,
+                      const vector<shared_ptr<Citizen>> &waitlist)
   {
-    vector<Event> events;
+    // Transform ticket holders to Tickets
+    vector<Ticket> tickets;
+    tickets.reserve(ticket_holders.size());
+    for (const shared_ptr<Citizen> &holder : ticket_holders)
+      tickets.push_back(Ticket(holder, &event));
+    event.load_ticket_holders(tickets);
+
+    event.load_waitlist(waitlist);
+  }
 
-    vector<string> event_strings = fileio::parse_file("program_data/confirmed_events.csv");
-    for (size_t i = 1; i < event_strings.size(); i++) // Ignore header line
+  void register_confirmed_event(const shared_ptr<Event> &event)
+  {
+    // Add the tickets to the Citizen's tickets
+    for (const Ticket &t : event->get_tickets())
     {
-      const string &event_str = event_strings[i];
-
-      stringstream ss(event_str);
-      string item;
-      char token = ',';
-
-      string date;
-      string time;
-      string layout_str;
-      string guest_type_str;
-      string is_public_str;
-      string price;
-      string duration;
-      string payment_amount;
-      string cc;
-      string cvv;
-      string expiration_date;
-      string organizer_username;
-      string tickets_str;
-      string waitlist_str;
-
-      getline(ss, date, token);
-      getline(ss, time, token);
-      getline(ss, layout_str, token);
-      getline(ss, guest_type_str, token);
-      getline(ss, is_public_str, token);
-      getline(ss, price, token);
-      getline(ss, duration, token);
-      getline(ss, payment_amount, token);
-      getline(ss, cc, token);
-      getline(ss, cvv, token);
-      getline(ss, expiration_date, token);
-      getline(ss, organizer_username, token);
-      getline(ss, tickets_str, token);  // May be empty
-      getline(ss, waitlist_str, token); // May be empty
-
-      // Transform data from strings to appropriate types
-      DateTime dt(date, time);
-      Event::LayoutType layout = event_utils::str_to_layout_type(layout_str);
-      Event::GuestType guest_type = event_utils::str_to_guest_type(guest_type_str);
-      bool is_public = event_utils::str_to_is_public(is_public_str);
-      shared_ptr<User> organizer = user_utils::username_to_user(users, organizer_username);
-
-      // Create the Payment and Event
-      Payment payment(stod(payment_amount), stol(cc), stoi(cvv), expiration_date);
-      Event saved_event = Event(dt, layout, guest_type, is_public, stoi(price),
-                                stoi(duration), 40, payment, organizer);
-
-      // Transform ticket strings to Tickets
-      vector<Ticket> tickets;
-      fileio::sanitize_lines(tickets_str);
-      if (!tickets_str.empty())
-      {
-        stringstream ss_tickets(tickets_str);
-        string user;
-        while (getline(ss_tickets, user, ';'))
-          tickets.push_back(Ticket(dynamic_pointer_cast<Citizen>(user_utils::username_to_user(users, user)), make_shared<Event>(saved_event)));
-      }
-      saved_event.load_ticket_holders(tickets);
+      shared_ptr<Citizen> ticket_holder = t.get_holder();
+      ticket_holder->add_ticket(t);
+    }
 
-      // Add these tickets to the Citizen's tickets
-      for (const Ticket &t : tickets)
-      {
-        shared_ptr<Citizen> ticket_holder = t.get_holder();
-        ticket_holder->add_ticket(t);
-      }
+    // Add this event to the organizer's booked events
+    if (const shared_ptr<User> &organizer = event->get_organizer())
+      organizer->add_event(event);
+  }
 
-      // Transform waitlist string to Citizens on the waitlist
-      vector<shared_ptr<Citizen>> citizens_on_waitlist;
-      fileio::sanitize_lines(waitlist_str);
-      if (!waitlist_str.empty())
+  void attach_confirmed_event(const shared_ptr<Event> &event, const vector<shared_ptr<Citizen>> &ticket_holders,
+                              const vector<shared_ptr<Citizen>> &waitlist)
+  {
+    load_attendees(*event, ticket_holders, waitlist);
+    register_confirmed_event(event);
+  }
+
+  EventSchema csv_header_to_schema(string_view header)
+  {
+    EventSchema schema;
+    fill(begin(schema.positions), end(schema.positions), -1);
+    schema.width = 0;
+    bool names_columns = false;
+    while (!header.empty() && schema.width < MAX_EVENT_COLUMNS)
+    {
+      string_view name = fileio::next_field(header, ',');
+      if (!name.empty() && name.back() == '\r')
+        name.remove_suffix(1);
+      for (int column = 0; column < EventSchema::COLUMN_COUNT; column++)
       {
-        stringstream ss_waitlist(waitlist_str);
-        string current_username;
-        while (getline(ss_waitlist, current_username, ';'))
-          citizens_on_waitlist.push_back(dynamic_pointer_cast<Citizen>(user_utils::username_to_user(users, current_username)));
+        if (name == EVENT_COLUMN_NAMES[column] && schema.positions[column] < 0)
+        {
+          schema.positions[column] = schema.width;
+          names_columns = true;
+        }
       }
-      saved_event.load_waitlist(citizens_on_waitlist);
+      schema.width++;
+    }
+    if (!names_columns)
+      return fixed_schema(EventSchema::WITHOUT_CAPACITY, COLUMNS_WITHOUT_CAPACITY, size(COLUMNS_WITHOUT_CAPACITY));
 
-      // Add this event to the organizer's booked events
-      if (auto citizen_ptr = dynamic_pointer_cast<Citizen>(organizer))
-        citizen_ptr->add_event(saved_event);
-      else if (auto client_ptr = dynamic_pointer_cast<Client>(organizer))
-        client_ptr->add_event(saved_event);
+    schema.layout = matches_order(schema, COLUMNS_WITHOUT_CAPACITY, size(COLUMNS_WITHOUT_CAPACITY)) ? EventSchema::WITHOUT_CAPACITY
+                    : matches_order(schema, COLUMNS_WITH_CAPACITY, size(COLUMNS_WITH_CAPACITY))     ? EventSchema::WITH_CAPACITY
+                                                                                                    : EventSchema::MAPPED;
+    return schema;
+  }
 
-      events.push_back(saved_event);
+  EventRow csv_to_event_row(string_view line, const EventSchema &schema)
+  {
+    switch (schema.layout)
+    {
+    case EventSchema::WITHOUT_CAPACITY:
+      return csv_to_event_row_in_order<false>(line);
+    case EventSchema::WITH_CAPACITY:
+      return csv_to_event_row_in_order<true>(line);
+    default:
+      return csv_to_event_row_mapped(line, schema);
     }
+  }
+
+  Event row_to_confirmed_event(const EventRow &row, const UserDirectory &users,
+                               vector<shared_ptr<Citizen>> &ticket_holders, vector<shared_ptr<Citizen>> &waitlist)
+  {
+    Event event(row.dt, row.layout, row.guest_type, row.is_public, row.price_per_ticket, row.duration, row.capacity,
+                row.payment, users.find(row.organizer));
+
+    // Transform ticket and waitlist strings to Citizens
+    string_view tickets_str = row.tickets;
+    while (!tickets_str.empty())
+      ticket_holders.push_back(Citizen::from_user(users.find(fileio::next_field(tickets_str, ';'))));
+    string_view waitlist_str = row.waitlist;
+    while (!waitlist_str.empty())
+      waitlist.push_back(Citizen::from_user(users.find(fileio::next_field(waitlist_str, ';'))));
+
+    return event;
+  }
+
+  ReservationRequest row_to_pending_event(const EventRow &row, const UserDirectory &users)
+  {
+    shared_ptr<User> requester = users.find(row.organizer);
+    return ReservationRequest(row.dt, row.layout, row.guest_type, row.is_public, row.price_per_ticket, row.duration,
+                              row.payment, requester);
+  }
+
+  size_t for_each_confirmed_event(const string &file_path, const UserDirectory &users,
+                                  const function<bool(const shared_ptr<Event> &)> &on_event)
+  {
+    EventSchema schema;
+    return for_each_data_line(file_path, [&schema](string_view header)
+                              { schema = csv_header_to_schema(header); },
+                              [&](string_view line)
+                              {
+      vector<shared_ptr<Citizen>> ticket_holders;
+      vector<shared_ptr<Citizen>> citizens_on_waitlist;
+      auto event = make_shared<Event>(row_to_confirmed_event(csv_to_event_row(line, schema), users, ticket_holders,
+                                                             citizens_on_waitlist));
+      load_attendees(*event, ticket_holders, citizens_on_waitlist);
+      return on_event(event); });
+  }
 
+  vector<shared_ptr<Event>> load_confirmed_events(const UserDirectory &users)
+  {
+    vector<shared_ptr<Event>> events;
+    for_each_confirmed_event("program_data/confirmed_events.csv", users, [&events](const shared_ptr<Event> &event)
+                             {
+      register_confirmed_event(event);
+      events.push_back(event);
+      return true; });
     return events;
   }
 
-  void save_confirmed_events(const vector<Event> &events)
+  string confirmed_event_to_csv(const Event &event)
+  {
+    const Payment &payment = event.get_payment();
+    string payment_str = to_string(payment.get_amount()) + "," + to_string(payment.get_card_number()) + "," +
+                         to_string(payment.get_cvv()) + "," + payment.get_expiry_date();
+
+    string ticket_str = "";
+    for (const Ticket &ticket : event.get_tickets())
+    {
+      if (!ticket_str.empty())
+        ticket_str += ";";
+      ticket_str += ticket.get_holder_username();
+    }
+    string waitlist_str = "";
+    for (const shared_ptr<Citizen> &citizen : event.get_waitlist())
+    {
+      if (!waitlist_str.empty())
+        waitlist_str += ";";
+      waitlist_str += citizen->get_username();
+    }
+    return event.get_date() + "," + event.get_time() + "," + layout_type_to_str(event.get_layout()) + "," +
+           guest_type_to_str(event.get_guest_type()) + "," + (event.get_is_public() ? "public" : "private") + "," +
+           to_string(event.get_price_per_ticket()) + "," + to_string(event.get_duration()) + "," +
+           to_string(event.get_capacity()) + "," + payment_str + "," + event.get_organizer()->get_username() + "," +
+           ticket_str + "," + waitlist_str;
+  }
+
+  void save_confirmed_events(const Schedule &events, fileio::WriteBatch *batch)
   {
     vector<string> event_strings;
 
     // Add header
-    event_strings.push_back("DATE,TIME,LAYOUT,GUEST_TYPE,IS_PUBLIC,PRICE,DURATION,PAYMENT_AMOUNT,CC,CVV,EXPIRY,ORGANIZER,TICKETS,WAITLIST");
+    event_strings.push_back("DATE,TIME,LAYOUT,GUEST_TYPE,IS_PUBLIC,PRICE,DURATION,CAPACITY,PAYMENT_AMOUNT,CC,CVV,EXPIRY,ORGANIZER,TICKETS,WAITLIST");
 
-    for (const auto &event : events)
-    {
-      Payment payment = event.get_payment();
-      string payment_str = to_string(payment.get_amount()) + "," + to_string(payment.get_card_number()) + "," +
-                           to_string(payment.get_cvv()) + "," + payment.get_expiry_date();
+    for (const auto &entry : events)
+      event_strings.push_back(confirmed_event_to_csv(*entry.second));
 
-      vector<Ticket> tickets = event.get_tickets();
-      string ticket_str = "";
-      for (size_t i = 0; i < tickets.size(); i++)
-      {
-        ticket_str += tickets[i].get_holder_username();
-        if (i < tickets.size() - 1)
-          ticket_str += ";";
-      }
-      queue<shared_ptr<Citizen>> waitlist_queue = event.get_waitlist();
-      vector<shared_ptr<Citizen>> waitlist;
-      // convert queue to vector
-      while (!waitlist_queue.empty())
-      {
-        waitlist.push_back(waitlist_queue.front());
-        waitlist_queue.pop();
-      }
-      string waitlist_str = "";
-      for (size_t i = 0; i < waitlist.size(); i++)
-      {
-        waitlist_str += waitlist[i]->get_username();
-        if (i < waitlist.size() - 1)
-          waitlist_str += ";";
-      }
-      string event_str = event.get_date() + "," + event.get_time() + "," + layout_type_to_str(event.get_layout()) + "," +
-                         guest_type_to_str(event.get_guest_type()) + "," + (event.get_is_public() ? "public" : "private") + "," +
-                         to_string(event.get_price_per_ticket()) + "," + to_string(event.get_duration()) + "," + payment_str + "," +
-                         event.get_organizer()->get_username() + "," + ticket_str + "," + waitlist_str;
-
-      event_strings.push_back(event_str);
-    }
+    if (batch != nullptr)
+      batch->add("program_data/confirmed_events.csv", event_strings);
+    else
+      fileio::write_to_file("program_data/confirmed_events.csv", event_strings);
+  }
 
-    fileio::write_to_file("program_data/confirmed_events.csv", event_strings);
+  ReservationRequest csv_to_pending_event(string_view line, const UserDirectory &users)
+  {
+    return row_to_pending_event(csv_to_event_row_in_order<false>(line), users);
   }
 
-  vector<ReservationRequest> load_pending_events(const vector<shared_ptr<User>> &users)
+  string pending_event_to_csv(const ReservationRequest &event)
   {
-    vector<ReservationRequest> events;
+    Payment payment = event.get_payment();
+    string payment_str = to_string(payment.get_amount()) + "," + to_string(payment.get_card_number()) + "," +
+                         to_string(payment.get_cvv()) + "," + payment.get_expiry_date();
+
+    return event.get_date() + "," + event.get_time() + "," + layout_type_to_str(event.get_layout()) + "," +
+           guest_type_to_str(event.get_guest_type()) + "," + (event.get_is_public() ? "public" : "private") + "," +
+           to_string(event.get_price_per_ticket()) + "," + to_string(event.get_duration()) + "," + payment_str + "," +
+           event.get_requester()->get_username();
+  }
 
-    vector<string> event_strings = fileio::parse_file("program_data/pending_events.csv");
-    for (size_t i = 1; i < event_strings.size(); i++) // Ignore header line
-    {
-      const string &event_str = event_strings[i];
-
-      stringstream ss(event_str);
-      string item;
-      char token = ',';
-
-      string date;
-      string time;
-      string layout_str;
-      string guest_type_str;
-      string is_public_str;
-      string price;
-      string duration;
-      string payment_amount;
-      string cc;
-      string cvv;
-      string expiration_date;
-      string organizer_username;
-
-      getline(ss, date, token);
-      getline(ss, time, token);
-      getline(ss, layout_str, token);
-      getline(ss, guest_type_str, token);
-      getline(ss, is_public_str, token);
-      getline(ss, price, token);
-      getline(ss, duration, token);
-      getline(ss, payment_amount, token);
-      getline(ss, cc, token);
-      getline(ss, cvv, token);
-      getline(ss, expiration_date, token);
-      getline(ss, organizer_username, token);
-
-      // Transform data from strings to appropriate types
-      DateTime dt(date, time);
-      Event::LayoutType layout = event_utils::str_to_layout_type(layout_str);
-      Event::GuestType guest_type = event_utils::str_to_guest_type(guest_type_str);
-      bool is_public = event_utils::str_to_is_public(is_public_str);
-      shared_ptr<User> organizer = user_utils::username_to_user(users, organizer_username);
-
-      // Create the Payment and ReservationRequest
-      Payment payment(stod(payment_amount), stol(cc), stoi(cvv), expiration_date);
-      ReservationRequest pending_event = ReservationRequest(dt, layout, guest_type, is_public, stoi(price),
-                                                            stoi(duration), payment, organizer);
-
-      events.push_back(pending_event);
-    }
+  size_t for_each_pending_event(const string &file_path, const UserDirectory &users,
+                                const function<bool(ReservationRequest &)> &on_event)
+  {
+    EventSchema schema;
+    return for_each_data_line(file_path, [&schema](string_view header)
+                              { schema = csv_header_to_schema(header); },
+                              [&](string_view line)
+                              {
+      ReservationRequest request = row_to_pending_event(csv_to_event_row(line, schema), users);
+      return on_event(request); });
+  }
 
+  vector<ReservationRequest> load_pending_events(const UserDirectory &users)
+  {
+    vector<ReservationRequest> events;
+    for_each_pending_event("program_data/pending_events.csv", users, [&events](ReservationRequest &event)
+                           {
+      events.push_back(event);
+      return true; });
     return events;
   }
 
-  void save_pending_events(const vector<ReservationRequest> &events)
+  void save_pending_events(const PendingRequests &events, fileio::WriteBatch *batch)
   {
     vector<string> event_strings;
 
@@ -386,20 +745,12 @@ namespace event_utils
     event_strings.push_back("DATE,TIME,LAYOUT,GUEST_TYPE,IS_PUBLIC,PRICE,DURATION,PAYMENT_AMOUNT,CC,CVV,EXPIRY,ORGANIZER");
 
     for (const auto &event : events)
-    {
-      Payment payment = event.get_payment();
-      string payment_str = to_string(payment.get_amount()) + "," + to_string(payment.get_card_number()) + "," +
-                           to_string(payment.get_cvv()) + "," + payment.get_expiry_date();
-
-      string event_str = event.get_date() + "," + event.get_time() + "," + layout_type_to_str(event.get_layout()) + "," +
-                         guest_type_to_str(event.get_guest_type()) + "," + (event.get_is_public() ? "public" : "private") + "," +
-                         to_string(event.get_price_per_ticket()) + "," + to_string(event.get_duration()) + "," + payment_str + "," +
-                         event.get_requester()->get_username();
+      event_strings.push_back(pending_event_to_csv(event));
 
-      event_strings.push_back(event_str);
-    }
-
-    fileio::write_to_file("program_data/pending_events.csv", event_strings);
+    if (batch != nullptr)
+      batch->add("program_data/pending_events.csv", event_strings);
+    else
+      fileio::write_to_file("program_data/pending_events.csv", event_strings);
   }
 
 }
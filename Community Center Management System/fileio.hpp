@@ -1,9 +1,15 @@
+#pragma once
+
 #include "User.hpp"
 #include "Event.hpp"
 #include "ReservationRequest.hpp"
+#include "PendingRequests.hpp"
+#include "UserDirectory.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <functional>
 
 using namespace std;
 
@@ -18,45 +24,177 @@ namespace fileio
   vector<string> parse_file(const string &file_path);
 
   /**
-   * Writes content to a file line by line.
+   * Replaces the content of a file atomically. The content is written to a temporary file with a
+   * single write, fsynced and renamed over the file, so a crash leaves either the old or the new file.
+   *
+   * @param file_path the file path to write to
+   * @param content the new content of the file
+   * @return was the file replaced
+   */
+  bool replace_file(const string &file_path, string_view content);
+
+  /**
+   * Writes content to a file line by line, replacing the file atomically.
    *
    * @param file_path the file path to write to
    * @param content the content to write to the file, where each item is written on a new line
    */
   void write_to_file(const string &file_path, const vector<string> &content);
 
+  /**
+   * A set of files that are replaced together. All files are written and fsynced first, then a commit
+   * record listing them is made durable before any of them is renamed into place. If the program stops
+   * during the renames, recover_write_batch finishes them on the next start, so the files are always
+   * either all old or all new.
+   */
+  class WriteBatch
+  {
+  private:
+    vector<pair<string, string>> files; // file path and new content
+
+  public:
+    /**
+     * Adds a file to the batch.
+     *
+     * @param file_path the file path to write to
+     * @param content the content to write to the file, where each item is written on a new line
+     */
+    void add(const string &file_path, const vector<string> &content);
+    /**
+     * Replaces every file in the batch.
+     *
+     * @return were the files replaced
+     */
+    bool commit();
+  };
+
+  /**
+   * Finishes a WriteBatch that was interrupted after it was committed, or discards one that was not.
+   * Must run before any file a batch may have written is read.
+   */
+  void recover_write_batch();
+
   /**
    * Removes CR and LF from the given string.
    *
    * @param str the string to remove CR and LF from
    */
   void sanitize_lines(string &str);
+
+  /**
+   * A read-only memory mapping of a file. The file content can be tokenized in place as string_views,
+   * which stay valid for as long as the MappedFile is alive.
+   */
+  class MappedFile
+  {
+  private:
+    const char *data;
+    size_t size;
+
+  public:
+    /**
+     * Maps the given file into memory. A file that cannot be opened is reported and mapped as empty content.
+     *
+     * @param file_path the file path to map
+     */
+    explicit MappedFile(const string &file_path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * Gets the mapped content of the file.
+     *
+     * @return a view over the whole file content
+     */
+    string_view content() const;
+    /**
+     * Drops the pages before the given position from memory, so that reading a large file from start
+     * to end only keeps a bounded part of it resident. The content stays readable; dropped pages are
+     * read back from the file if they are accessed again.
+     *
+     * @param position a position in the content, up to which whole pages are dropped
+     */
+    void discard_before(const char *position) const;
+  };
+
+  /**
+   * Pops the next line off the front of the given content. CR and LF are not included in the line.
+   *
+   * @param content the remaining content, which is advanced past the line
+   * @param line the popped line
+   * @return false if there was no content left
+   */
+  bool next_line(string_view &content, string_view &line);
+
+  /**
+   * Pops the next field off the front of the given line.
+   *
+   * @param line the remaining line, which is advanced past the field and its separator
+   * @param sep the field separator
+   * @return the popped field (empty if the line is exhausted)
+   */
+  string_view next_field(string_view &line, char sep);
+
+  /**
+   * Splits a line into fields by the given separator.
+   *
+   * @param line the line to split
+   * @param sep the field separator
+   * @param fields the output fields, where missing trailing fields are left empty
+   * @param max_fields the number of fields to fill
+   * @return the number of fields found in the line
+   */
+  size_t split_fields(string_view line, char sep, string_view *fields, size_t max_fields);
+
+  /**
+   * Parses an int from a field, defaulting to 0 if it is not a number.
+   */
+  int to_int(string_view s);
+
+  /**
+   * Parses a long from a field, defaulting to 0 if it is not a number.
+   */
+  long to_long(string_view s);
+
+  /**
+   * Parses a double from a field, defaulting to 0 if it is not a number.
+   */
+  double to_double(string_view s);
 }
 
 namespace user_utils
 {
   /**
-   * Loads saved users from a saved file.
+   * Creates a User from a line of users.csv.
    *
-   * @return the users that have been registered to the app as a vector of User pointers
+   * @param line the CSV line
+   * @return the User
    */
-  vector<shared_ptr<User>> load_saved_users();
+  shared_ptr<User> csv_to_user(string_view line);
 
   /**
-   * Saves a vector of users to a saved file.
+   * Returns the users.csv line for a User.
    *
-   * @param users the users to save to a file
+   * @param user_ptr the User
+   * @return the CSV line
    */
-  void save_users(const vector<shared_ptr<User>> &users);
+  string user_to_csv(const shared_ptr<User> &user_ptr);
 
   /**
-   * Returns a pointer to a User given a username. Returns nullptr if the User
-   * doesn't exist.
+   * Loads saved users from a saved file. A line repeating an earlier username is skipped.
    *
-   * @param users the User's to search
-   * @param s the User's username.
+   * @return the users that have been registered to the app
    */
-  shared_ptr<User> username_to_user(const vector<shared_ptr<User>> users, const string &s);
+  UserDirectory load_saved_users();
+
+  /**
+   * Saves a vector of users to a saved file.
+   *
+   * @param users the users to save to a file
+   * @param batch the WriteBatch to add the file to, or nullptr to write it right away
+   */
+  void save_users(const vector<shared_ptr<User>> &users, fileio::WriteBatch *batch = nullptr);
 }
 
 namespace event_utils
@@ -67,7 +205,7 @@ namespace event_utils
    * @param s the LayoutType as a string
    * @return the LayoutType
    */
-  Event::LayoutType str_to_layout_type(const string &s);
+  Event::LayoutType str_to_layout_type(string_view s);
 
   /**
    * Returns the GuestType from a string.
@@ -75,7 +213,7 @@ namespace event_utils
    * @param s the GuestType as a string
    * @return the GuestType
    */
-  Event::GuestType str_to_guest_type(const string &s);
+  Event::GuestType str_to_guest_type(string_view s);
 
   /**
    * Returns a string from the LayoutType.
@@ -99,7 +237,146 @@ namespace event_utils
    * @param s the public/private as a string
    * @return is the event public
    */
-  bool str_to_is_public(const string &s);
+  bool str_to_is_public(string_view s);
+
+  /**
+   * The fields of a line of confirmed_events.csv or pending_events.csv, with the users left as
+   * usernames so that the line can be parsed before the users are loaded. The views point into the line.
+   */
+  struct EventRow
+  {
+    DateTime dt;
+    Event::LayoutType layout;
+    Event::GuestType guest_type;
+    bool is_public;
+    int price_per_ticket;
+    int duration;
+    int capacity; // Event::DEFAULT_CAPACITY if the file has no CAPACITY column
+    Payment payment;
+    string_view organizer;
+    string_view tickets;  // ';' separated usernames, empty for pending events
+    string_view waitlist; // ';' separated usernames, empty for pending events
+  };
+
+  /**
+   * Where each column of an events CSV is, as named by its header line. Files in one of the layouts
+   * this program writes are parsed with a fast path for that layout; any other order of columns is
+   * looked up through the positions. Columns the file lacks are read as empty fields.
+   */
+  struct EventSchema
+  {
+    enum Column
+    {
+      DATE,
+      TIME,
+      LAYOUT,
+      GUEST_TYPE,
+      IS_PUBLIC,
+      PRICE,
+      DURATION,
+      CAPACITY,
+      PAYMENT_AMOUNT,
+      CC,
+      CVV,
+      EXPIRY,
+      ORGANIZER,
+      TICKETS,
+      WAITLIST,
+      COLUMN_COUNT
+    };
+
+    enum Layout
+    {
+      WITHOUT_CAPACITY, // the original columns, as pending_events.csv and older confirmed_events.csv
+      WITH_CAPACITY,    // CAPACITY after DURATION, as confirmed_events.csv
+      MAPPED            // anything else
+    };
+
+    Layout layout;
+    int positions[COLUMN_COUNT]; // the index of each column in a line, or -1 if the file lacks it
+    size_t width;                // the number of columns in a line
+  };
+
+  /**
+   * Reads the header line of confirmed_events.csv or pending_events.csv. A first line that names
+   * none of the columns is taken to be from a file without a header, in the original column order.
+   *
+   * @param header the header line
+   * @return the schema of the lines that follow
+   */
+  EventSchema csv_header_to_schema(string_view header);
+
+  /**
+   * Parses a line of confirmed_events.csv or pending_events.csv.
+   *
+   * @param line the CSV line
+   * @param schema the schema read from the file's header
+   * @return the parsed fields
+   */
+  EventRow csv_to_event_row(string_view line, const EventSchema &schema);
+
+  /**
+   * Creates a confirmed Event from a parsed line, resolving its organizer, ticket holders and waitlist.
+   *
+   * @param row the parsed line
+   * @param users the Users in the program
+   * @param ticket_holders the output Citizens holding tickets to the Event, in purchase order
+   * @param waitlist the output Citizens on the Event's waitlist, in queue order
+   * @return the Event, without its tickets and waitlist attached
+   */
+  Event row_to_confirmed_event(const EventRow &row, const UserDirectory &users,
+                               vector<shared_ptr<Citizen>> &ticket_holders, vector<shared_ptr<Citizen>> &waitlist);
+
+  /**
+   * Creates a ReservationRequest from a parsed line, resolving its requester.
+   *
+   * @param row the parsed line
+   * @param users the Users in the program
+   * @return the ReservationRequest
+   */
+  ReservationRequest row_to_pending_event(const EventRow &row, const UserDirectory &users);
+
+  /**
+   * Gives a loaded confirmed Event its tickets and waitlist. The Tickets refer to the Event by address,
+   * so it must already be where it stays, normally behind the handle the Facility will own.
+   *
+   * @param event the loaded Event
+   * @param ticket_holders the Citizens holding tickets to the Event, in purchase order
+   * @param waitlist the Citizens on the Event's waitlist, in queue order
+   */
+  void load_attendees(Event &event, const vector<shared_ptr<Citizen>> &ticket_holders,
+                      const vector<shared_ptr<Citizen>> &waitlist);
+
+  /**
+   * Adds a loaded confirmed Event to its organizer's events and each of its tickets to its holder's tickets.
+   *
+   * @param event the handle of the loaded Event, with its attendees
+   */
+  void register_confirmed_event(const shared_ptr<Event> &event);
+
+  /**
+   * Gives a loaded confirmed Event its tickets and waitlist, and adds the Event to its organizer's
+   * events and each ticket to its holder's tickets.
+   *
+   * @param event the handle of the loaded Event
+   * @param ticket_holders the Citizens holding tickets to the Event, in purchase order
+   * @param waitlist the Citizens on the Event's waitlist, in queue order
+   */
+  void attach_confirmed_event(const shared_ptr<Event> &event, const vector<shared_ptr<Citizen>> &ticket_holders,
+                              const vector<shared_ptr<Citizen>> &waitlist);
+
+  /**
+   * Reads confirmed events one at a time, keeping only a bounded part of the file in memory. Each
+   * Event has its tickets and waitlist, but is not registered with its Users; the callback can pass
+   * it to register_confirmed_event to do so.
+   *
+   * @param file_path the confirmed events file
+   * @param users the Users in the program
+   * @param on_event called with the handle of each Event in file order, which it may keep; returns false to stop reading
+   * @return the number of Events read
+   */
+  size_t for_each_confirmed_event(const string &file_path, const UserDirectory &users,
+                                  const function<bool(const shared_ptr<Event> &)> &on_event);
 
   /**
    * Loads confirmed events from a file.
@@ -107,14 +384,51 @@ namespace event_utils
    * @param users the Users in the program
    * @return the Events that have been previously confirmed
    */
-  vector<Event> load_confirmed_events(const vector<shared_ptr<User>> &users);
+  vector<shared_ptr<Event>> load_confirmed_events(const UserDirectory &users);
+
+  /**
+   * Returns the confirmed_events.csv line for an Event.
+   *
+   * @param event the Event
+   * @return the CSV line
+   */
+  string confirmed_event_to_csv(const Event &event);
 
   /**
    * Saves confirmed events to a file.
    *
    * @param events the confirmed Events to save
+   * @param batch the WriteBatch to add the file to, or nullptr to write it right away
+   */
+  void save_confirmed_events(const Schedule &events, fileio::WriteBatch *batch = nullptr);
+
+  /**
+   * Creates a ReservationRequest from a line in the format written by pending_event_to_csv.
+   *
+   * @param line the CSV line
+   * @param users the Users in the program
+   * @return the ReservationRequest
+   */
+  ReservationRequest csv_to_pending_event(string_view line, const UserDirectory &users);
+
+  /**
+   * Returns the pending_events.csv line for a ReservationRequest.
+   *
+   * @param event the ReservationRequest
+   * @return the CSV line
+   */
+  string pending_event_to_csv(const ReservationRequest &event);
+
+  /**
+   * Reads pending events one at a time, keeping only a bounded part of the file in memory.
+   *
+   * @param file_path the pending events file
+   * @param users the Users in the program
+   * @param on_event called with each ReservationRequest in file order; returns false to stop reading
+   * @return the number of ReservationRequests read
    */
-  void save_confirmed_events(const vector<Event> &events);
+  size_t for_each_pending_event(const string &file_path, const UserDirectory &users,
+                                const function<bool(ReservationRequest &)> &on_event);
 
   /**
    * Loads pending events from a file.
@@ -122,12 +436,13 @@ namespace event_utils
    * @param users the Users in the program
    * @return the Events that are pending confirmation
    */
-  vector<ReservationRequest> load_pending_events(const vector<shared_ptr<User>> &users);
+  vector<ReservationRequest> load_pending_events(const UserDirectory &users);
 
   /**
    * Saves pending events to a file.
    *
-   * @param events the pending Events to save
+   * @param events the pending Events to save, in submission order
+   * @param batch the WriteBatch to add the file to, or nullptr to write it right away
    */
-  void save_pending_events(const vector<ReservationRequest> &events);
+  void save_pending_events(const PendingRequests &events, fileio::WriteBatch *batch = nullptr);
 }
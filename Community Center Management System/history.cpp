@@ -0,0 +1,337 @@
+#include "history.hpp"
+#include "fileio.hpp"
+#include "Citizen.hpp"
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+  // A block is its payload size and checksum, followed by the payload:
+  //   event count
+  //   username dictionary: count, then each username
+  //   card dictionary: count, then each card number, CVV and expiry date
+  //   events: start minute delta, packed enums, price, duration, capacity, payment amount, card ID,
+  //           organizer ID, ticket holder IDs, waitlist IDs
+  // Integers are varints; signed ones are zigzag encoded first. Strings are a varint length and bytes.
+  const size_t BLOCK_HEADER_SIZE = 2 * sizeof(uint32_t);
+  const size_t BLOCK_EVENTS = 1024; // bounds the memory a block pins while it is decoded
+  const size_t DISCARD_INTERVAL = 1 << 20; // bytes decoded between dropping pages while streaming
+
+  uint32_t checksum(string_view data)
+  {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c : data)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
+  void put_varint(string &out, uint64_t value)
+  {
+    while (value >= 0x80)
+    {
+      out += static_cast<char>(value | 0x80);
+      value >>= 7;
+    }
+    out += static_cast<char>(value);
+  }
+
+  void put_signed(string &out, int64_t value)
+  {
+    put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+
+  void put_string(string &out, const string &s)
+  {
+    put_varint(out, s.size());
+    out += s;
+  }
+
+  /**
+   * Reads values off the front of a block payload. Reading past the end marks the reader as failed.
+   */
+  class BlockReader
+  {
+  private:
+    string_view data;
+    bool failed;
+
+  public:
+    explicit BlockReader(string_view data) : data(data), failed(false) {}
+
+    uint64_t varint()
+    {
+      uint64_t value = 0;
+      for (int shift = 0; shift < 64 && !data.empty(); shift += 7)
+      {
+        uint8_t byte = data.front();
+        data.remove_prefix(1);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          return value;
+      }
+      failed = true;
+      return 0;
+    }
+
+    int64_t signed_varint()
+    {
+      uint64_t value = varint();
+      return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    string_view bytes(size_t count)
+    {
+      if (count > data.size())
+      {
+        failed = true;
+        return string_view();
+      }
+      string_view result = data.substr(0, count);
+      data.remove_prefix(count);
+      return result;
+    }
+
+    string_view str() { return bytes(varint()); }
+
+    // A number of entries that follow, each of which takes at least a byte
+    size_t count()
+    {
+      uint64_t value = varint();
+      if (value > data.size())
+      {
+        failed = true;
+        return 0;
+      }
+      return value;
+    }
+
+    bool ok() const { return !failed; }
+  };
+
+  /**
+   * Assigns dictionary IDs in order of first use.
+   */
+  uint32_t dictionary_id(unordered_map<string, uint32_t> &ids, vector<const string *> &entries, const string &key)
+  {
+    auto inserted = ids.emplace(key, static_cast<uint32_t>(entries.size()));
+    if (inserted.second)
+      entries.push_back(&inserted.first->first);
+    return inserted.first->second;
+  }
+
+  struct Card
+  {
+    long card_number;
+    int cvv;
+    string expiry_date;
+  };
+
+  /**
+   * Decodes one block payload, calling on_event with each Event. Returns false if the payload is
+   * malformed or on_event asked to stop.
+   */
+  bool decode_block(string_view payload, const UserDirectory &users,
+                    const function<bool(const shared_ptr<Event> &)> &on_event, size_t &count)
+  {
+    BlockReader reader(payload);
+    uint64_t event_count = reader.count();
+
+    // Each username is resolved once per block; ticket holders and waitlists only refer to Citizens
+    vector<shared_ptr<User>> names(reader.count());
+    vector<shared_ptr<Citizen>> citizens(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      names[i] = users.find(reader.str());
+      citizens[i] = Citizen::from_user(names[i]);
+    }
+
+    vector<Card> cards(reader.count());
+    for (Card &card : cards)
+    {
+      card.card_number = reader.signed_varint();
+      card.cvv = reader.signed_varint();
+      card.expiry_date = string(reader.str());
+    }
+    if (!reader.ok())
+      return false;
+
+    // IDs past the dictionary resolve to a trailing nullptr
+    size_t unknown = names.size();
+    names.push_back(nullptr);
+    citizens.push_back(nullptr);
+    auto read_id = [&]()
+    {
+      uint64_t id = reader.varint();
+      return id < unknown ? id : unknown;
+    };
+
+    long long start = 0;
+    vector<shared_ptr<Citizen>> ticket_holders;
+    vector<shared_ptr<Citizen>> waitlist;
+    for (uint64_t i = 0; i < event_count; i++)
+    {
+      start += reader.signed_varint();
+      uint8_t flags = reader.varint();
+      int price = reader.signed_varint();
+      int duration = reader.signed_varint();
+      int capacity = reader.signed_varint();
+      double amount;
+      string_view amount_bytes = reader.bytes(sizeof(amount));
+      uint64_t card_id = reader.varint();
+      const shared_ptr<User> &organizer = names[read_id()];
+
+      ticket_holders.assign(reader.count(), nullptr);
+      for (shared_ptr<Citizen> &holder : ticket_holders)
+        holder = citizens[read_id()];
+      waitlist.assign(reader.count(), nullptr);
+      for (shared_ptr<Citizen> &citizen : waitlist)
+        citizen = citizens[read_id()];
+      if (!reader.ok() || card_id >= cards.size())
+        return false;
+
+      memcpy(&amount, amount_bytes.data(), sizeof(amount));
+      const Card &card = cards[card_id];
+      auto event = make_shared<Event>(DateTime(start), static_cast<Event::LayoutType>(flags & 0x3),
+                                      static_cast<Event::GuestType>((flags >> 2) & 0x3), (flags >> 4) & 0x1, price, duration,
+                                      capacity, Payment(amount, card.card_number, card.cvv, card.expiry_date), organizer);
+      event_utils::load_attendees(*event, ticket_holders, waitlist);
+      count++;
+      if (!on_event(event))
+        return false;
+    }
+    return true;
+  }
+
+  string encode_block(const vector<const Event *> &events, size_t begin, size_t end)
+  {
+    unordered_map<string, uint32_t> name_ids;
+    vector<const string *> names;
+    unordered_map<string, uint32_t> card_ids;
+    vector<const string *> card_keys;
+    vector<Card> cards;
+
+    string body;
+    long long previous_start = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+      const Event *event = events[i];
+      long long start = event->get_dt().minutes_since_epoch();
+      put_signed(body, start - previous_start);
+      previous_start = start;
+      put_varint(body, event->get_layout() | event->get_guest_type() << 2 | event->get_is_public() << 4);
+      put_signed(body, event->get_price_per_ticket());
+      put_signed(body, event->get_duration());
+      put_signed(body, event->get_capacity());
+
+      const Payment &payment = event->get_payment();
+      double amount = payment.get_amount();
+      body.append(reinterpret_cast<const char *>(&amount), sizeof(amount));
+      string card_key = to_string(payment.get_card_number()) + "," + to_string(payment.get_cvv()) + "," +
+                        payment.get_expiry_date();
+      uint32_t card_id = dictionary_id(card_ids, card_keys, card_key);
+      if (card_id == cards.size())
+        cards.push_back(Card{payment.get_card_number(), payment.get_cvv(), payment.get_expiry_date()});
+      put_varint(body, card_id);
+
+      put_varint(body, dictionary_id(name_ids, names, event->get_organizer()->get_username()));
+      const TicketHolders &tickets = event->get_tickets();
+      put_varint(body, tickets.size());
+      for (const Ticket &ticket : tickets)
+        put_varint(body, dictionary_id(name_ids, names, ticket.get_holder_username()));
+      const Waitlist &waitlist = event->get_waitlist();
+      put_varint(body, waitlist.size());
+      for (const shared_ptr<Citizen> &citizen : waitlist)
+        put_varint(body, dictionary_id(name_ids, names, citizen->get_username()));
+    }
+
+    string payload;
+    put_varint(payload, end - begin);
+    put_varint(payload, names.size());
+    for (const string *name : names)
+      put_string(payload, *name);
+    put_varint(payload, cards.size());
+    for (const Card &card : cards)
+    {
+      put_signed(payload, card.card_number);
+      put_signed(payload, card.cvv);
+      put_string(payload, card.expiry_date);
+    }
+    payload += body;
+
+    uint32_t header[2] = {static_cast<uint32_t>(payload.size()), checksum(payload)};
+    string block(reinterpret_cast<const char *>(header), BLOCK_HEADER_SIZE);
+    return block + payload;
+  }
+}
+
+namespace history
+{
+  string encode(const vector<const Event *> &events)
+  {
+    string blocks;
+    for (size_t begin = 0; begin < events.size(); begin += BLOCK_EVENTS)
+      blocks += encode_block(events, begin, min(events.size(), begin + BLOCK_EVENTS));
+    return blocks;
+  }
+
+  off_t valid_length(int fd, off_t offset, off_t end)
+  {
+    // Blocks are made durable before the next one is appended, so only the last one can be torn
+    uint32_t header[2];
+    off_t last = offset;
+    while (offset + static_cast<off_t>(BLOCK_HEADER_SIZE) <= end &&
+           pread(fd, header, BLOCK_HEADER_SIZE, offset) == static_cast<ssize_t>(BLOCK_HEADER_SIZE) &&
+           offset + static_cast<off_t>(BLOCK_HEADER_SIZE + header[0]) <= end)
+    {
+      last = offset;
+      offset += BLOCK_HEADER_SIZE + header[0];
+    }
+    if (offset == last)
+      return offset;
+
+    // Check the last complete block, which may still hold garbage if the crash came before its data
+    string payload(offset - last - BLOCK_HEADER_SIZE, '\0');
+    if (pread(fd, header, BLOCK_HEADER_SIZE, last) != static_cast<ssize_t>(BLOCK_HEADER_SIZE) ||
+        pread(fd, payload.data(), payload.size(), last + BLOCK_HEADER_SIZE) != static_cast<ssize_t>(payload.size()) ||
+        checksum(payload) != header[1])
+      return last;
+    return offset;
+  }
+
+  size_t for_each_event(const string &file_path, size_t offset, const UserDirectory &users,
+                        const function<bool(const shared_ptr<Event> &)> &on_event)
+  {
+    fileio::MappedFile file(file_path);
+    string_view content = file.content();
+    const char *discarded = content.data();
+    size_t count = 0;
+
+    content.remove_prefix(min(offset, content.size()));
+    while (content.size() >= BLOCK_HEADER_SIZE)
+    {
+      uint32_t header[2];
+      memcpy(header, content.data(), BLOCK_HEADER_SIZE);
+      if (content.size() - BLOCK_HEADER_SIZE < header[0])
+        break;
+      string_view payload = content.substr(BLOCK_HEADER_SIZE, header[0]);
+      if (checksum(payload) != header[1] || !decode_block(payload, users, on_event, count))
+        break;
+
+      content.remove_prefix(BLOCK_HEADER_SIZE + header[0]);
+      if (size_t(content.data() - discarded) >= DISCARD_INTERVAL)
+      {
+        file.discard_before(content.data());
+        discarded = content.data();
+      }
+    }
+    return count;
+  }
+}
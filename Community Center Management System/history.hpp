@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Event.hpp"
+#include "UserDirectory.hpp"
+#include <string>
+#include <vector>
+#include <functional>
+#include <sys/types.h>
+
+using namespace std;
+
+// Compact binary encoding of past confirmed events, used by the EventArchive. Events are stored in
+// self-contained blocks, so new Events can be appended without rewriting the file. Within a block,
+// usernames and payment cards are stored once in a dictionary and referenced by varint IDs, and the
+// event start times are delta encoded against the previous event.
+namespace history
+{
+  /**
+   * Encodes Events as a run of blocks.
+   *
+   * @param events the Events, in the order they are read back
+   * @return the blocks, each with its size and checksum
+   */
+  string encode(const vector<const Event *> &events);
+
+  /**
+   * Finds the end of the last complete block in a file, so that a block torn by a crash while it was
+   * being appended can be cut off. Only the block headers and the last block are read.
+   *
+   * @param fd the file, open for reading
+   * @param offset the position of the first block
+   * @param end the size of the file
+   * @return the position after the last complete block
+   */
+  off_t valid_length(int fd, off_t offset, off_t end);
+
+  /**
+   * Decodes the blocks of a file one Event at a time, keeping only a bounded part of the file in
+   * memory. Usernames are resolved once per block. Each Event has its tickets and waitlist, but is
+   * not registered with its Users. Decoding stops at the first incomplete or corrupt block.
+   *
+   * @param file_path the file
+   * @param offset the position of the first block
+   * @param users the Users in the program
+   * @param on_event called with the handle of each Event in file order, which it may keep; returns false to stop reading
+   * @return the number of Events read
+   */
+  size_t for_each_event(const string &file_path, size_t offset, const UserDirectory &users,
+                        const function<bool(const shared_ptr<Event> &)> &on_event);
+}
@@ -0,0 +1,183 @@
+#include "loader.hpp"
+#include "fileio.hpp"
+#include "ThreadPool.hpp"
+#include "Citizen.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+  const size_t MIN_CHUNK_SIZE = 64 * 1024; // smaller chunks cost more to schedule than to parse
+  const size_t MAX_THREADS = 8;
+
+  struct ResolvedEvent
+  {
+    shared_ptr<Event> event;
+    vector<shared_ptr<Citizen>> ticket_holders;
+    vector<shared_ptr<Citizen>> waitlist;
+  };
+
+  /**
+   * Splits content into chunks of roughly equal size that each end at a line boundary.
+   */
+  vector<string_view> split_chunks(string_view content, size_t chunk_count)
+  {
+    vector<string_view> chunks;
+    size_t target_size = max(MIN_CHUNK_SIZE, content.size() / chunk_count + 1);
+    while (!content.empty())
+    {
+      size_t end = content.size() <= target_size ? string_view::npos : content.find('\n', target_size);
+      if (end == string_view::npos)
+      {
+        chunks.push_back(content);
+        break;
+      }
+      chunks.push_back(content.substr(0, end + 1));
+      content.remove_prefix(end + 1);
+    }
+    return chunks;
+  }
+
+  string_view read_header(string_view content, event_utils::EventSchema &schema)
+  {
+    string_view header;
+    fileio::next_line(content, header);
+    schema = event_utils::csv_header_to_schema(header);
+    return content;
+  }
+
+  /**
+   * Measures the time between consecutive laps.
+   */
+  class Stopwatch
+  {
+  private:
+    chrono::steady_clock::time_point last;
+
+  public:
+    Stopwatch() : last(chrono::steady_clock::now()) {}
+
+    double lap_ms()
+    {
+      chrono::steady_clock::time_point now = chrono::steady_clock::now();
+      double elapsed = chrono::duration<double, milli>(now - last).count();
+      last = now;
+      return elapsed;
+    }
+  };
+}
+
+namespace loader
+{
+  void load_csvs(snapshot::State &state)
+  {
+    state = snapshot::State();
+    Stopwatch stopwatch;
+
+    // Phase 1: map the files and split them into chunks
+    fileio::MappedFile users_file("program_data/users.csv");
+    fileio::MappedFile confirmed_file("program_data/confirmed_events.csv");
+    fileio::MappedFile pending_file("program_data/pending_events.csv");
+
+    size_t thread_count = max<size_t>(1, min<size_t>(MAX_THREADS, thread::hardware_concurrency()));
+    vector<string_view> user_chunks = split_chunks(users_file.content(), thread_count);
+    event_utils::EventSchema confirmed_schema, pending_schema;
+    vector<string_view> confirmed_chunks = split_chunks(read_header(confirmed_file.content(), confirmed_schema), thread_count);
+    vector<string_view> pending_chunks = split_chunks(read_header(pending_file.content(), pending_schema), thread_count);
+    size_t event_chunk_count = confirmed_chunks.size() + pending_chunks.size();
+
+    ThreadPool pool(min(thread_count, max<size_t>(1, user_chunks.size() + event_chunk_count)));
+    double read_ms = stopwatch.lap_ms();
+
+    // Phase 2: parse every chunk of every file; the events only keep the usernames they name
+    vector<vector<shared_ptr<User>>> user_parts(user_chunks.size());
+    vector<vector<event_utils::EventRow>> confirmed_rows(confirmed_chunks.size());
+    vector<vector<event_utils::EventRow>> pending_rows(pending_chunks.size());
+    pool.run(user_chunks.size() + event_chunk_count, [&](size_t i)
+             {
+      string_view content;
+      string_view line;
+      if (i < user_chunks.size())
+      {
+        content = user_chunks[i];
+        while (fileio::next_line(content, line))
+        {
+          if (!line.empty())
+            user_parts[i].push_back(user_utils::csv_to_user(line));
+        }
+        return;
+      }
+
+      i -= user_chunks.size();
+      bool is_confirmed = i < confirmed_chunks.size();
+      content = is_confirmed ? confirmed_chunks[i] : pending_chunks[i - confirmed_chunks.size()];
+      vector<event_utils::EventRow> &rows = is_confirmed ? confirmed_rows[i] : pending_rows[i - confirmed_chunks.size()];
+      const event_utils::EventSchema &schema = is_confirmed ? confirmed_schema : pending_schema;
+      while (fileio::next_line(content, line))
+      {
+        if (!line.empty())
+          rows.push_back(event_utils::csv_to_event_row(line, schema));
+      } });
+    double parse_ms = stopwatch.lap_ms();
+
+    // Phase 3: publish the user table in file order, so the first User with a username wins
+    size_t user_count = 0;
+    for (const vector<shared_ptr<User>> &part : user_parts)
+      user_count += part.size();
+    state.users.reserve(user_count);
+    for (const vector<shared_ptr<User>> &part : user_parts)
+    {
+      for (const shared_ptr<User> &user : part)
+        state.users.add(user);
+    }
+    const UserDirectory &users = state.users;
+    double publish_ms = stopwatch.lap_ms();
+
+    // Phase 4: resolve the users named in every event, which only reads the user table
+    vector<vector<ResolvedEvent>> confirmed_parts(confirmed_rows.size());
+    vector<vector<ReservationRequest>> pending_parts(pending_rows.size());
+    pool.run(event_chunk_count, [&](size_t i)
+             {
+      if (i < confirmed_rows.size())
+      {
+        for (const event_utils::EventRow &row : confirmed_rows[i])
+        {
+          vector<shared_ptr<Citizen>> ticket_holders;
+          vector<shared_ptr<Citizen>> waitlist;
+          auto event = make_shared<Event>(event_utils::row_to_confirmed_event(row, users, ticket_holders, waitlist));
+          confirmed_parts[i].push_back(ResolvedEvent{move(event), move(ticket_holders), move(waitlist)});
+        }
+        return;
+      }
+
+      i -= confirmed_rows.size();
+      for (const event_utils::EventRow &row : pending_rows[i])
+        pending_parts[i].push_back(event_utils::row_to_pending_event(row, users)); });
+    double resolve_ms = stopwatch.lap_ms();
+
+    // Phase 5: attach the events to their users in file order, which updates the Users
+    for (vector<ResolvedEvent> &part : confirmed_parts)
+    {
+      for (ResolvedEvent &resolved : part)
+      {
+        event_utils::attach_confirmed_event(resolved.event, resolved.ticket_holders, resolved.waitlist);
+        state.confirmed_events.push_back(move(resolved.event));
+      }
+    }
+    for (vector<ReservationRequest> &part : pending_parts)
+      state.pending_events.insert(state.pending_events.end(), part.begin(), part.end());
+    double attach_ms = stopwatch.lap_ms();
+
+    streamsize precision = cout.precision();
+    cout << fixed << setprecision(3) << "Loaded " << state.users.size() << " users, " << state.confirmed_events.size()
+         << " confirmed events and " << state.pending_events.size() << " pending events on " << pool.get_thread_count()
+         << (pool.get_thread_count() == 1 ? " thread" : " threads") << " in " << read_ms + parse_ms + publish_ms + resolve_ms + attach_ms << " ms (read " << read_ms
+         << ", parse " << parse_ms << ", users " << publish_ms << ", resolve " << resolve_ms << ", attach " << attach_ms
+         << ")" << endl;
+    cout << defaultfloat << setprecision(precision);
+  }
+}
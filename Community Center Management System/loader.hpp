@@ -0,0 +1,20 @@
+#pragma once
+
+#include "snapshot.hpp"
+
+using namespace std;
+
+// Parallel startup loading of the CSVs in program_data. The result is identical to loading them one
+// after another with user_utils::load_saved_users and event_utils::load_*_events.
+namespace loader
+{
+  /**
+   * Loads the users, confirmed events and pending events from the CSVs. Each file is split into
+   * chunks at line boundaries, which are parsed in parallel; the users named in the events are
+   * resolved once the whole user table is loaded, and the events are then attached to their users
+   * in file order. The time spent in each phase is reported.
+   *
+   * @param state the state to fill
+   */
+  void load_csvs(snapshot::State &state);
+}
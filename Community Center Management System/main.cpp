@@ -1,27 +1,39 @@
 #include "Facility.hpp"
+#include "Journal.hpp"
 #include "fileio.hpp"
+#include "snapshot.hpp"
+#include "loader.hpp"
 #include "prompt.hpp"
 #include <iostream>
 #include <limits>
 #include <string>
 #include <vector>
 #include <memory>
-#include <algorithm>
 
 using namespace std;
 
+const size_t COMPACTION_THRESHOLD = 1000; // journal records that trigger a save of the whole state
+
 void display_login();
-shared_ptr<User> login(const vector<shared_ptr<User>> &users);
-shared_ptr<User> register_user(const vector<shared_ptr<User>> &users);
-void handle_login_option(int option, vector<shared_ptr<User>> &users, shared_ptr<User> &logged_in_user);
+shared_ptr<User> login(const UserDirectory &users);
+shared_ptr<User> register_user(const UserDirectory &users);
+void handle_login_option(int option, UserDirectory &users, shared_ptr<User> &logged_in_user, Facility &facility,
+                         Journal &journal, snapshot::Layout &layout);
+void save_state(const UserDirectory &users, Facility &facility, Journal &journal, snapshot::Layout &layout,
+                bool export_csvs);
 
 int main()
 {
-  vector<shared_ptr<User>> users = user_utils::load_saved_users();
+  // Finish a save of the CSVs that was interrupted, then prefer the binary snapshot when it is newer
+  fileio::recover_write_batch();
+  snapshot::State state;
+  snapshot::Layout layout;
+  if (!snapshot::is_fresh() || !snapshot::load(state, layout))
+    loader::load_csvs(state);
+  UserDirectory &users = state.users;
 
   // Load the FacilityManager
-  auto manager_ptr = find_if(users.begin(), users.end(), [](const shared_ptr<User> &user)
-                             { return user->get_username() == "BradStevens"; });
+  shared_ptr<User> manager_ptr = users.find("BradStevens");
 
   // Get the mock time for the program
   cout << "Before running this program, you must enter a Date and Time to simulate when this program is being "
@@ -32,9 +44,20 @@ int main()
   string mock_time = prompt::get_user_time_input();
   DateTime mock_dt(mock_date, mock_time);
 
-  Facility facility(*manager_ptr, mock_dt);
-  facility.load_saved_confirmed_events(event_utils::load_confirmed_events(users));
-  facility.load_saved_pending_events(event_utils::load_pending_events(users));
+  Facility facility(manager_ptr, mock_dt);
+  facility.load_saved_confirmed_events(move(state.confirmed_events));
+  facility.load_saved_pending_events(state.pending_events);
+
+  // Replay the changes made since the state was last saved, then record new ones
+  Journal journal("program_data/journal.log");
+  journal.replay(users, facility);
+  facility.attach_journal(&journal);
+
+  // Keep only upcoming events in memory; past ones are read back when a history needs them
+  EventArchive archive("program_data/archived_events.dat", users);
+  archive.import_csv("program_data/archived_events.csv");
+  facility.attach_archive(&archive);
+  facility.archive_past_events();
 
   cout << "\nWelcome to the Newton Community Center!" << endl;
   while (true)
@@ -48,21 +71,51 @@ int main()
       cin.clear();
       cin.ignore(numeric_limits<streamsize>::max(), '\n');
       cin >> login_option;
-      handle_login_option(login_option, users, logged_in_user);
+      handle_login_option(login_option, users, logged_in_user, facility, journal, layout);
       if (logged_in_user != nullptr)
         break;
     }
     logged_in_user->handle_menu_input(facility);
+
+    // Compact the journal into the snapshot once it grows large; only changed records are written
+    if (journal.get_record_count() >= COMPACTION_THRESHOLD)
+      save_state(users, facility, journal, layout, false);
   }
 
-  // Save data
-  user_utils::save_users(users);
-  event_utils::save_confirmed_events(facility.get_confirmed_events());
-  event_utils::save_pending_events(facility.get_pending_events());
+  save_state(users, facility, journal, layout, true);
 
   return EXIT_SUCCESS;
 }
 
+/**
+ * Saves all users and events to the binary snapshot, optionally exporting them to the CSVs first so
+ * that the snapshot stays the newest copy. The journal is emptied once the state is saved, since the
+ * saved state now includes all of its records.
+ *
+ * @param users all of the users registered in the system
+ * @param facility the Facility holding the events
+ * @param journal the journal of changes since the last save
+ * @param layout the layout of the snapshot file, so only changed records are rewritten
+ * @param export_csvs should the CSVs be rewritten as well
+ */
+void save_state(const UserDirectory &users, Facility &facility, Journal &journal, snapshot::Layout &layout,
+                bool export_csvs)
+{
+  if (export_csvs)
+  {
+    // The three CSVs reference each other, so they are replaced together
+    fileio::WriteBatch batch;
+    user_utils::save_users(users.get_users(), &batch);
+    event_utils::save_confirmed_events(facility.get_confirmed_events(), &batch);
+    event_utils::save_pending_events(facility.get_pending_events(), &batch);
+    batch.commit();
+  }
+  // Without the CSVs, the journal is the only other copy of the changes
+  if (snapshot::save(users, facility.get_confirmed_events(), facility.get_pending_events(), layout) || export_csvs)
+    journal.reset();
+  facility.save_archive();
+}
+
 /**
  * Displays all login options for a user.
  */
@@ -80,7 +133,7 @@ void display_login()
  * @param users all of the users registered in the system
  * @return a pointer to the logged in user
  */
-shared_ptr<User> login(const vector<shared_ptr<User>> &users)
+shared_ptr<User> login(const UserDirectory &users)
 {
   while (true)
   {
@@ -91,9 +144,8 @@ shared_ptr<User> login(const vector<shared_ptr<User>> &users)
     {
       return nullptr;
     }
-    auto user_it = find_if(users.begin(), users.end(), [&username](const shared_ptr<User> &user)
-                           { return user->get_username() == username; });
-    if (user_it == users.end())
+    shared_ptr<User> user = users.find(username);
+    if (user == nullptr)
     {
       cin.clear();
       cin.ignore(numeric_limits<streamsize>::max(), '\n');
@@ -105,10 +157,10 @@ shared_ptr<User> login(const vector<shared_ptr<User>> &users)
       cout << "Please enter your password: ";
       string password;
       cin >> password;
-      if ((*user_it)->get_password() == password)
+      if (user->get_password() == password)
       {
         cout << "Login successful!" << endl;
-        return *user_it;
+        return user;
       }
       else
       {
@@ -135,7 +187,7 @@ shared_ptr<User> login(const vector<shared_ptr<User>> &users)
  * @param users all of the users registered in the system
  * @return the newly created user as a pointer
  */
-shared_ptr<User> register_user(const vector<shared_ptr<User>> &users)
+shared_ptr<User> register_user(const UserDirectory &users)
 {
   while (true)
   {
@@ -146,8 +198,7 @@ shared_ptr<User> register_user(const vector<shared_ptr<User>> &users)
     {
       return nullptr;
     }
-    if (find_if(users.begin(), users.end(), [&username](const shared_ptr<User> &user)
-                { return user->get_username() == username; }) != users.end())
+    if (users.contains(username))
     {
       cin.clear();
       cin.ignore(numeric_limits<streamsize>::max(), '\n');
@@ -207,8 +258,12 @@ shared_ptr<User> register_user(const vector<shared_ptr<User>> &users)
  * @param option the authentication method (1. login, 2. register, 3. exit)
  * @param users all of the users registered in the system
  * @param logged_in_user a pointer that holds the currently logged in user
+ * @param facility the Facility, which is saved on exit
+ * @param journal the journal that registrations are recorded to
+ * @param layout the layout of the snapshot file that is saved on exit
  */
-void handle_login_option(int option, vector<shared_ptr<User>> &users, shared_ptr<User> &logged_in_user)
+void handle_login_option(int option, UserDirectory &users, shared_ptr<User> &logged_in_user, Facility &facility,
+                         Journal &journal, snapshot::Layout &layout)
 {
   switch (option)
   {
@@ -228,7 +283,9 @@ void handle_login_option(int option, vector<shared_ptr<User>> &users, shared_ptr
     shared_ptr<User> created_user = register_user(users);
     if (created_user != nullptr)
     {
-      users.push_back(created_user);
+      users.add(created_user);
+      journal.append(Journal::REGISTER, user_utils::user_to_csv(created_user));
+      journal.commit();
       cout << "Registration successful!" << endl;
     }
     else
@@ -240,7 +297,7 @@ void handle_login_option(int option, vector<shared_ptr<User>> &users, shared_ptr
   }
   case 3:
     cout << "Goodbye!" << endl;
-    user_utils::save_users(users); // Save any newly created users
+    save_state(users, facility, journal, layout, true); // Save any newly created users and events
     exit(EXIT_SUCCESS);
   default:
     cin.clear();
@@ -0,0 +1,65 @@
+#include "pricing.hpp"
+
+using namespace std;
+
+namespace
+{
+  struct Rates
+  {
+    double service_charge;
+    double hourly_rate;
+  };
+
+  // Indexed by User::Category
+  const Rates RATES[User::CATEGORY_COUNT] = {
+      {10, 10}, // RESIDENT
+      {10, 15}, // NONRESIDENT
+      {10, 5},  // CITY
+      {10, 20}, // ORGANIZATION
+      {0, 0},   // MANAGER
+  };
+
+  // Indexed by how many of the refund deadlines (24 hours, a week) are still ahead of the event
+  const double REFUND_FRACTIONS[3] = {0, 0.99, 1};
+
+  double cost(const pricing::Reservation &reservation)
+  {
+    const Rates &rates = RATES[reservation.category];
+    return rates.service_charge + rates.hourly_rate * reservation.duration_in_hours;
+  }
+
+  double refund(const pricing::Cancellation &cancellation)
+  {
+    int tier = (cancellation.hours_until_start > 24) + (cancellation.hours_until_start > 168);
+    return (cancellation.paid - RATES[cancellation.category].service_charge) * REFUND_FRACTIONS[tier];
+  }
+}
+
+namespace pricing
+{
+  double reservation_cost(Category category, int duration_in_hours)
+  {
+    return cost(Reservation{category, duration_in_hours});
+  }
+
+  double cancellation_refund(Category category, double paid, int hours_until_start)
+  {
+    return refund(Cancellation{category, paid, hours_until_start});
+  }
+
+  vector<double> quote_batch(const vector<Reservation> &reservations)
+  {
+    vector<double> costs(reservations.size());
+    for (size_t i = 0; i < reservations.size(); i++)
+      costs[i] = cost(reservations[i]);
+    return costs;
+  }
+
+  vector<double> quote_batch(const vector<Cancellation> &cancellations)
+  {
+    vector<double> refunds(cancellations.size());
+    for (size_t i = 0; i < cancellations.size(); i++)
+      refunds[i] = refund(cancellations[i]);
+    return refunds;
+  }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "User.hpp"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// What the Facility charges for reserving an event and refunds when one is canceled. The rates,
+// service charges and refund tiers are a table indexed by the requester's User::Category, so pricing a
+// reservation or cancellation is a few loads and arithmetic with no branches, and a batch of them can
+// be priced in a single pass.
+namespace pricing
+{
+  using Category = User::Category; // the FacilityManager's Category is not charged
+
+  /**
+   * A hypothetical reservation to price.
+   */
+  struct Reservation
+  {
+    Category category;
+    int duration_in_hours;
+  };
+
+  /**
+   * A hypothetical cancellation to price.
+   */
+  struct Cancellation
+  {
+    Category category;
+    double paid; // what the reservation cost
+    int hours_until_start;
+  };
+
+  /**
+   * Calculates the cost of reserving an event: a $10 service charge, and an hourly rate of $10 for
+   * Residents, $15 for Non-Residents, $20 for Organizations and $5 for the City.
+   *
+   * @param category the Category of the requester
+   * @param duration_in_hours the duration of the event
+   * @return the cost
+   */
+  double reservation_cost(Category category, int duration_in_hours);
+  /**
+   * Calculates the refund for canceling a reserved event. The service charge is not refundable; the
+   * rest is refunded in full more than a week before the event, less a 1% penalty more than 24 hours
+   * before it, and not at all within 24 hours.
+   *
+   * @param category the Category of the organizer
+   * @param paid what the reservation cost
+   * @param hours_until_start the whole hours from now until the event starts
+   * @return the refund
+   */
+  double cancellation_refund(Category category, double paid, int hours_until_start);
+
+  /**
+   * Prices a batch of reservations.
+   *
+   * @param reservations the reservations
+   * @return the cost of each reservation, in the same order
+   */
+  vector<double> quote_batch(const vector<Reservation> &reservations);
+  /**
+   * Prices a batch of cancellations.
+   *
+   * @param cancellations the cancellations
+   * @return the refund for each cancellation, in the same order
+   */
+  vector<double> quote_batch(const vector<Cancellation> &cancellations);
+}
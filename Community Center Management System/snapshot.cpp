@@ -0,0 +1,685 @@
+#include "snapshot.hpp"
+#include "fileio.hpp"
+#include "Citizen.hpp"
+#include "Client.hpp"
+#include "FacilityManager.hpp"
+#include "DateTime.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+  const char *SNAPSHOT_PATH = "program_data/state.snapshot";
+  const char *CSV_PATHS[] = {"program_data/users.csv", "program_data/confirmed_events.csv", "program_data/pending_events.csv"};
+
+  const char MAGIC[8] = {'C', 'C', 'M', 'S', 'N', 'A', 'P', '\0'};
+  const uint32_t VERSION = 2;
+  const uint32_t NO_HANDLE = UINT32_MAX;
+
+  enum UserTag : uint8_t
+  {
+    MANAGER_TAG,
+    CITIZEN_TAG,
+    CLIENT_TAG
+  };
+
+  // The file is a Header followed by the user, confirmed event and pending event record tables and
+  // finally the pool of user handles that the event records' ticket and waitlist spans point into.
+  // Every table is preallocated to its capacity so records never move; users are referenced
+  // everywhere by their slot in the user table.
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t user_count;
+    uint32_t user_capacity;
+    uint32_t event_slots;
+    uint32_t event_capacity;
+    uint32_t pending_slots;
+    uint32_t pending_capacity;
+    uint32_t handle_used;
+    uint32_t handle_capacity;
+  };
+
+  struct UserRecord
+  {
+    uint8_t tag;
+    uint8_t status; // ResidentStatus or ClientType
+    char username[32];
+    char password[32];
+  };
+
+  // Used for both confirmed and pending events; pending events have empty ticket and waitlist spans.
+  // The waitlist handles directly follow the ticket handles in the span.
+  struct EventRecord
+  {
+    uint8_t live; // freed slots are zeroed
+    char date[11];
+    char time[6];
+    uint8_t layout;
+    uint8_t guest_type;
+    uint8_t is_public;
+    int32_t price_per_ticket;
+    int32_t duration;
+    int32_t capacity;
+    double payment_amount;
+    int64_t card_number;
+    int32_t cvv;
+    char expiry[8];
+    uint32_t organizer;
+    uint32_t ticket_begin;
+    uint32_t ticket_count;
+    uint32_t waitlist_count;
+    uint32_t span_capacity;
+  };
+
+  template <size_t N>
+  bool copy_field(char (&dst)[N], const string &src)
+  {
+    if (src.size() >= N)
+      return false;
+    memset(dst, 0, N);
+    memcpy(dst, src.data(), src.size());
+    return true;
+  }
+
+  template <size_t N>
+  string read_field(const char (&src)[N])
+  {
+    return string(src, strnlen(src, N));
+  }
+
+  template <typename T>
+  void append_record(vector<char> &buffer, const T &record)
+  {
+    const char *bytes = reinterpret_cast<const char *>(&record);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+  }
+
+  template <typename T>
+  T read_record(const char *base, size_t index)
+  {
+    T record;
+    memcpy(&record, base + index * sizeof(T), sizeof(T));
+    return record;
+  }
+
+  bool modified_time(const char *path, timespec &mtime)
+  {
+    struct stat st;
+    if (stat(path, &st) != 0)
+      return false;
+    mtime = st.st_mtim;
+    return true;
+  }
+
+  uint32_t grown_capacity(size_t count, size_t minimum)
+  {
+    return max(minimum, count * 2);
+  }
+
+  // Byte offsets of each table for a given layout
+  size_t event_table_offset(const snapshot::Layout &layout)
+  {
+    return sizeof(Header) + layout.user_capacity * sizeof(UserRecord);
+  }
+  size_t pending_table_offset(const snapshot::Layout &layout)
+  {
+    return event_table_offset(layout) + layout.event_capacity * sizeof(EventRecord);
+  }
+  size_t handle_pool_offset(const snapshot::Layout &layout)
+  {
+    return pending_table_offset(layout) + layout.pending_capacity * sizeof(EventRecord);
+  }
+
+  Header make_header(const snapshot::Layout &layout)
+  {
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.user_count = layout.user_count;
+    header.user_capacity = layout.user_capacity;
+    header.event_slots = layout.event_slots;
+    header.event_capacity = layout.event_capacity;
+    header.pending_slots = layout.pending_slots;
+    header.pending_capacity = layout.pending_capacity;
+    header.handle_used = layout.handle_used;
+    header.handle_capacity = layout.handle_capacity;
+    return header;
+  }
+
+  bool make_user_record(UserRecord &record, const shared_ptr<User> &user)
+  {
+    memset(&record, 0, sizeof(record));
+    switch (user->get_category())
+    {
+    case User::RESIDENT:
+    case User::NONRESIDENT:
+      record.tag = CITIZEN_TAG;
+      record.status = static_cast<const Citizen &>(*user).get_resident_status();
+      break;
+    case User::CITY:
+    case User::ORGANIZATION:
+      record.tag = CLIENT_TAG;
+      record.status = static_cast<const Client &>(*user).get_client_type();
+      break;
+    default:
+      record.tag = MANAGER_TAG;
+    }
+    return copy_field(record.username, user->get_username()) && copy_field(record.password, user->get_password());
+  }
+
+  bool fill_event_record(EventRecord &record, const DateTime &dt, Event::LayoutType layout, Event::GuestType guest_type,
+                         bool is_public, int price_per_ticket, int duration, int capacity, const Payment &payment, uint32_t organizer)
+  {
+    memset(&record, 0, sizeof(record));
+    record.live = 1;
+    record.layout = layout;
+    record.guest_type = guest_type;
+    record.is_public = is_public;
+    record.price_per_ticket = price_per_ticket;
+    record.duration = duration;
+    record.capacity = capacity;
+    record.payment_amount = payment.get_amount();
+    record.card_number = payment.get_card_number();
+    record.cvv = payment.get_cvv();
+    record.organizer = organizer;
+    return organizer != NO_HANDLE && copy_field(record.date, dt.get_date_str()) && copy_field(record.time, dt.get_time_str()) &&
+           copy_field(record.expiry, payment.get_expiry_date());
+  }
+
+  Payment record_payment(const EventRecord &record)
+  {
+    return Payment(record.payment_amount, record.card_number, record.cvv, read_field(record.expiry));
+  }
+
+  // Resolves Users to their slot in the user table, which is their index in the UserDirectory
+  class HandleResolver
+  {
+  private:
+    const UserDirectory &users;
+
+  public:
+    explicit HandleResolver(const UserDirectory &users) : users(users) {}
+
+    uint32_t operator()(const shared_ptr<User> &user) const
+    {
+      if (!user)
+        return NO_HANDLE;
+      size_t index = users.index_of(user->get_username());
+      return index == users.size() ? NO_HANDLE : index;
+    }
+  };
+
+  // Builds the record and handle span contents of a confirmed Event
+  bool make_event_record(EventRecord &record, vector<uint32_t> &span, const Event &event, const HandleResolver &handle_of)
+  {
+    bool fits = fill_event_record(record, event.get_dt(), event.get_layout(), event.get_guest_type(), event.get_is_public(),
+                                  event.get_price_per_ticket(), event.get_duration(), event.get_capacity(), event.get_payment(),
+                                  handle_of(event.get_organizer()));
+
+    span.clear();
+    for (const Ticket &ticket : event.get_tickets())
+      span.push_back(handle_of(ticket.get_holder()));
+    record.ticket_count = span.size();
+    for (const shared_ptr<Citizen> &citizen : event.get_waitlist())
+      span.push_back(handle_of(citizen));
+    record.waitlist_count = span.size() - record.ticket_count;
+
+    return fits && find(span.begin(), span.end(), NO_HANDLE) == span.end();
+  }
+
+  bool make_pending_record(EventRecord &record, const ReservationRequest &request, const HandleResolver &handle_of)
+  {
+    return fill_event_record(record, request.get_dt(), request.get_layout(), request.get_guest_type(), request.get_is_public(),
+                             request.get_price_per_ticket(), request.get_duration(), Event::DEFAULT_CAPACITY, request.get_payment(),
+                             handle_of(request.get_requester()));
+  }
+
+  // Pending requests are identified by their start and requester, since several users may request the same time
+  long long pending_key(const ReservationRequest &request, uint32_t requester)
+  {
+    return (request.get_dt().minutes_since_epoch() << 32) | requester;
+  }
+
+  bool write_at(int fd, size_t offset, const void *data, size_t size)
+  {
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0)
+    {
+      ssize_t written = pwrite(fd, bytes, size, offset);
+      if (written < 0)
+        return false;
+      bytes += written;
+      offset += written;
+      size -= written;
+    }
+    return true;
+  }
+
+  // Rewrites the whole snapshot file, leaving room in every table for the state to grow
+  bool save_full(const UserDirectory &users, const Schedule &confirmed_events,
+                 const PendingRequests &pending_events, snapshot::Layout &layout)
+  {
+    snapshot::Layout fresh;
+    fresh.user_count = users.size();
+    fresh.user_capacity = grown_capacity(users.size(), 64);
+    fresh.event_capacity = grown_capacity(confirmed_events.size(), 64);
+    fresh.pending_capacity = grown_capacity(pending_events.size(), 64);
+    bool unique_keys = true;
+
+    vector<char> user_table;
+    for (const shared_ptr<User> &user : users.get_users())
+    {
+      UserRecord record;
+      if (!make_user_record(record, user))
+      {
+        cout << "Username or password too long for the snapshot, skipping snapshot." << endl;
+        return false;
+      }
+      append_record(user_table, record);
+    }
+    user_table.resize(fresh.user_capacity * sizeof(UserRecord), 0);
+    HandleResolver handle_of(users);
+
+    vector<char> event_table;
+    vector<uint32_t> handle_pool;
+    vector<uint32_t> span;
+    for (const auto &entry : confirmed_events)
+    {
+      const Event &event = *entry.second;
+      EventRecord record;
+      if (!make_event_record(record, span, event, handle_of))
+      {
+        cout << "Event cannot be stored in the snapshot, skipping snapshot." << endl;
+        return false;
+      }
+      record.ticket_begin = handle_pool.size();
+      record.span_capacity = max<size_t>(8, span.size() * 2);
+      handle_pool.insert(handle_pool.end(), span.begin(), span.end());
+      handle_pool.resize(record.ticket_begin + record.span_capacity, 0);
+
+      snapshot::Layout::EventSlot slot = {fresh.event_slots++, event.get_version(), record.ticket_begin, record.span_capacity};
+      unique_keys &= fresh.events.emplace(event.get_dt().minutes_since_epoch(), slot).second;
+      append_record(event_table, record);
+    }
+    event_table.resize(fresh.event_capacity * sizeof(EventRecord), 0);
+
+    vector<char> pending_table;
+    for (const ReservationRequest &request : pending_events)
+    {
+      EventRecord record;
+      if (!make_pending_record(record, request, handle_of))
+      {
+        cout << "Event cannot be stored in the snapshot, skipping snapshot." << endl;
+        return false;
+      }
+      snapshot::Layout::EventSlot slot = {fresh.pending_slots++, request.get_version(), 0, 0};
+      unique_keys &= fresh.pending.emplace(pending_key(request, record.organizer), slot).second;
+      append_record(pending_table, record);
+    }
+    pending_table.resize(fresh.pending_capacity * sizeof(EventRecord), 0);
+
+    fresh.handle_used = handle_pool.size();
+    fresh.handle_capacity = grown_capacity(handle_pool.size(), 1024);
+    handle_pool.resize(fresh.handle_capacity, 0);
+
+    vector<char> buffer;
+    buffer.reserve(handle_pool_offset(fresh) + handle_pool.size() * sizeof(uint32_t));
+    append_record(buffer, make_header(fresh));
+    buffer.insert(buffer.end(), user_table.begin(), user_table.end());
+    buffer.insert(buffer.end(), event_table.begin(), event_table.end());
+    buffer.insert(buffer.end(), pending_table.begin(), pending_table.end());
+    const char *pool_bytes = reinterpret_cast<const char *>(handle_pool.data());
+    buffer.insert(buffer.end(), pool_bytes, pool_bytes + handle_pool.size() * sizeof(uint32_t));
+
+    if (!fileio::replace_file(SNAPSHOT_PATH, string_view(buffer.data(), buffer.size())))
+    {
+      layout = snapshot::Layout();
+      return false;
+    }
+
+    // Records sharing a key cannot be tracked individually, so such a file is always rewritten whole
+    layout = fresh;
+    layout.valid = unique_keys;
+    return true;
+  }
+
+  // Writes only the records that changed since the layout was recorded. Returns false without
+  // writing anything if the changes do not fit in the file's tables.
+  bool save_changes(const UserDirectory &users, const Schedule &confirmed_events,
+                    const PendingRequests &pending_events, snapshot::Layout &layout)
+  {
+    HandleResolver handle_of(users);
+    if (users.size() < layout.user_count || users.size() > layout.user_capacity)
+      return false;
+
+    // Find changed, added and removed events
+    vector<const Event *> changed_events;
+    unordered_set<long long> live_events;
+    size_t new_events = 0;
+    size_t new_span_handles = 0;
+    for (const auto &entry : confirmed_events)
+    {
+      const Event &event = *entry.second;
+      long long key = event.get_dt().minutes_since_epoch();
+      if (!live_events.insert(key).second)
+        return false;
+      auto it = layout.events.find(key);
+      if (it != layout.events.end() && it->second.version == event.get_version())
+        continue;
+
+      size_t needed = event.get_tickets().size() + event.get_waitlist().size();
+      if (it == layout.events.end())
+        new_events++;
+      if (it == layout.events.end() || needed > it->second.span_capacity)
+        new_span_handles += max<size_t>(8, needed * 2);
+      changed_events.push_back(&event);
+    }
+    vector<long long> removed_events;
+    if (live_events.size() - new_events != layout.events.size())
+    {
+      for (const auto &entry : layout.events)
+      {
+        if (!live_events.count(entry.first))
+          removed_events.push_back(entry.first);
+      }
+    }
+
+    // Find added and removed pending requests; a request never changes once submitted
+    vector<pair<long long, const ReservationRequest *>> added_pending;
+    unordered_set<long long> live_pending;
+    for (const ReservationRequest &request : pending_events)
+    {
+      long long key = pending_key(request, handle_of(request.get_requester()));
+      if (!live_pending.insert(key).second)
+        return false;
+      auto it = layout.pending.find(key);
+      if (it == layout.pending.end() || it->second.version != request.get_version())
+        added_pending.push_back(make_pair(key, &request));
+    }
+    vector<long long> removed_pending;
+    if (live_pending.size() - added_pending.size() != layout.pending.size())
+    {
+      for (const auto &entry : layout.pending)
+      {
+        if (!live_pending.count(entry.first))
+          removed_pending.push_back(entry.first);
+      }
+    }
+
+    // Check that the changes fit in the preallocated tables
+    if (new_events > layout.free_event_slots.size() + removed_events.size() + (layout.event_capacity - layout.event_slots) ||
+        added_pending.size() > layout.free_pending_slots.size() + removed_pending.size() + (layout.pending_capacity - layout.pending_slots) ||
+        new_span_handles > layout.handle_capacity - layout.handle_used)
+      return false;
+
+    int fd = open(SNAPSHOT_PATH, O_WRONLY);
+    if (fd < 0)
+      return false;
+    bool ok = true;
+
+    // Append new users
+    for (size_t i = layout.user_count; i < users.size() && ok; i++)
+    {
+      UserRecord record;
+      ok = make_user_record(record, users.get_users()[i]) &&
+           write_at(fd, sizeof(Header) + i * sizeof(UserRecord), &record, sizeof(record));
+    }
+    layout.user_count = users.size();
+
+    // Free removed records, then write changed ones
+    EventRecord empty_record;
+    memset(&empty_record, 0, sizeof(empty_record));
+    for (long long key : removed_events)
+    {
+      uint32_t slot = layout.events[key].slot;
+      ok = ok && write_at(fd, event_table_offset(layout) + slot * sizeof(EventRecord), &empty_record, sizeof(EventRecord));
+      layout.free_event_slots.push_back(slot);
+      layout.events.erase(key);
+    }
+    for (long long key : removed_pending)
+    {
+      uint32_t slot = layout.pending[key].slot;
+      ok = ok && write_at(fd, pending_table_offset(layout) + slot * sizeof(EventRecord), &empty_record, sizeof(EventRecord));
+      layout.free_pending_slots.push_back(slot);
+      layout.pending.erase(key);
+    }
+
+    vector<uint32_t> span;
+    for (const Event *event : changed_events)
+    {
+      EventRecord record;
+      ok = ok && make_event_record(record, span, *event, handle_of);
+      if (!ok)
+        break;
+
+      long long key = event->get_dt().minutes_since_epoch();
+      auto it = layout.events.find(key);
+      if (it == layout.events.end())
+      {
+        snapshot::Layout::EventSlot slot = {layout.event_slots, 0, 0, 0};
+        if (!layout.free_event_slots.empty())
+        {
+          slot.slot = layout.free_event_slots.back();
+          layout.free_event_slots.pop_back();
+        }
+        else
+          layout.event_slots++;
+        it = layout.events.emplace(key, slot).first;
+      }
+      snapshot::Layout::EventSlot &slot = it->second;
+      if (span.size() > slot.span_capacity)
+      {
+        slot.span_begin = layout.handle_used;
+        slot.span_capacity = max<size_t>(8, span.size() * 2);
+        layout.handle_used += slot.span_capacity;
+      }
+      slot.version = event->get_version();
+      record.ticket_begin = slot.span_begin;
+      record.span_capacity = slot.span_capacity;
+
+      ok = write_at(fd, handle_pool_offset(layout) + slot.span_begin * sizeof(uint32_t), span.data(), span.size() * sizeof(uint32_t)) &&
+           write_at(fd, event_table_offset(layout) + slot.slot * sizeof(EventRecord), &record, sizeof(EventRecord));
+    }
+
+    for (const auto &added : added_pending)
+    {
+      EventRecord record;
+      ok = ok && make_pending_record(record, *added.second, handle_of);
+      if (!ok)
+        break;
+
+      snapshot::Layout::EventSlot slot = {layout.pending_slots, added.second->get_version(), 0, 0};
+      if (!layout.free_pending_slots.empty())
+      {
+        slot.slot = layout.free_pending_slots.back();
+        layout.free_pending_slots.pop_back();
+      }
+      else
+        layout.pending_slots++;
+      layout.pending[added.first] = slot;
+      ok = write_at(fd, pending_table_offset(layout) + slot.slot * sizeof(EventRecord), &record, sizeof(EventRecord));
+    }
+
+    // The header goes last, so the new counts only cover records that were written
+    Header header = make_header(layout);
+    ok = ok && write_at(fd, 0, &header, sizeof(header)) && fdatasync(fd) == 0;
+    close(fd);
+
+    if (!ok)
+      layout = snapshot::Layout();
+    return ok;
+  }
+}
+
+namespace snapshot
+{
+  bool is_fresh()
+  {
+    timespec snapshot_time;
+    if (!modified_time(SNAPSHOT_PATH, snapshot_time))
+      return false;
+
+    for (const char *csv_path : CSV_PATHS)
+    {
+      timespec csv_time;
+      if (!modified_time(csv_path, csv_time))
+        continue;
+      // The snapshot is written after the CSVs, so a tie means it is up to date
+      if (csv_time.tv_sec > snapshot_time.tv_sec ||
+          (csv_time.tv_sec == snapshot_time.tv_sec && csv_time.tv_nsec > snapshot_time.tv_nsec))
+        return false;
+    }
+    return true;
+  }
+
+  bool load(State &state, Layout &layout)
+  {
+    state = State();
+    layout = Layout();
+
+    fileio::MappedFile file(SNAPSHOT_PATH);
+    string_view bytes = file.content();
+    if (bytes.size() < sizeof(Header))
+      return false;
+
+    Header header = read_record<Header>(bytes.data(), 0);
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    {
+      cout << "Snapshot has an unknown format, loading CSVs instead." << endl;
+      return false;
+    }
+    layout.user_capacity = header.user_capacity;
+    layout.event_slots = header.event_slots;
+    layout.event_capacity = header.event_capacity;
+    layout.pending_slots = header.pending_slots;
+    layout.pending_capacity = header.pending_capacity;
+    layout.handle_used = header.handle_used;
+    layout.handle_capacity = header.handle_capacity;
+    if (bytes.size() != handle_pool_offset(layout) + size_t(header.handle_capacity) * sizeof(uint32_t) ||
+        header.user_count > header.user_capacity || header.event_slots > header.event_capacity ||
+        header.pending_slots > header.pending_capacity || header.handle_used > header.handle_capacity)
+    {
+      cout << "Snapshot is truncated, loading CSVs instead." << endl;
+      layout = Layout();
+      return false;
+    }
+
+    const char *user_table = bytes.data() + sizeof(Header);
+    const char *event_table = bytes.data() + event_table_offset(layout);
+    const char *pending_table = bytes.data() + pending_table_offset(layout);
+    const char *handle_pool = bytes.data() + handle_pool_offset(layout);
+
+    // A repeated username would shift every later handle, so it invalidates the snapshot
+    bool valid = true;
+    state.users.reserve(header.user_count);
+    for (size_t i = 0; i < header.user_count && valid; i++)
+    {
+      UserRecord record = read_record<UserRecord>(user_table, i);
+      string username = read_field(record.username);
+      string password = read_field(record.password);
+      if (record.tag == MANAGER_TAG)
+        valid = state.users.add(make_shared<FacilityManager>(username, password));
+      else if (record.tag == CITIZEN_TAG)
+        valid = state.users.add(make_shared<Citizen>(username, password, static_cast<Citizen::ResidentStatus>(record.status)));
+      else
+        valid = state.users.add(make_shared<Client>(username, password, static_cast<Client::ClientType>(record.status)));
+    }
+    layout.user_count = state.users.size();
+    const vector<shared_ptr<User>> &users = state.users.get_users();
+
+    // Resolves a range of the handle pool to Citizens, failing on any handle that is not a Citizen
+    auto resolve_citizens = [&](uint32_t begin, uint32_t count, vector<shared_ptr<Citizen>> &citizens)
+    {
+      if (begin > header.handle_capacity || count > header.handle_capacity - begin)
+        return false;
+      for (size_t i = begin; i < size_t(begin) + count; i++)
+      {
+        uint32_t handle = read_record<uint32_t>(handle_pool, i);
+        shared_ptr<Citizen> citizen = handle < users.size() ? Citizen::from_user(users[handle]) : nullptr;
+        if (!citizen)
+          return false;
+        citizens.push_back(move(citizen));
+      }
+      return true;
+    };
+
+    state.confirmed_events.reserve(header.event_slots);
+    for (uint32_t i = 0; i < header.event_slots && valid; i++)
+    {
+      EventRecord record = read_record<EventRecord>(event_table, i);
+      if (!record.live)
+      {
+        layout.free_event_slots.push_back(i);
+        continue;
+      }
+
+      vector<shared_ptr<Citizen>> ticket_holders;
+      vector<shared_ptr<Citizen>> waitlist;
+      valid = record.organizer < users.size() && record.ticket_count + record.waitlist_count <= record.span_capacity &&
+              resolve_citizens(record.ticket_begin, record.ticket_count, ticket_holders) &&
+              resolve_citizens(record.ticket_begin + record.ticket_count, record.waitlist_count, waitlist);
+      if (!valid)
+        break;
+
+      auto event = make_shared<Event>(DateTime(read_field(record.date), read_field(record.time)),
+                                      static_cast<Event::LayoutType>(record.layout), static_cast<Event::GuestType>(record.guest_type),
+                                      record.is_public, record.price_per_ticket, record.duration, record.capacity,
+                                      record_payment(record), users[record.organizer]);
+      event_utils::attach_confirmed_event(event, ticket_holders, waitlist);
+      Layout::EventSlot slot = {i, event->get_version(), record.ticket_begin, record.span_capacity};
+      layout.events[event->get_dt().minutes_since_epoch()] = slot;
+      state.confirmed_events.push_back(move(event));
+    }
+
+    state.pending_events.reserve(header.pending_slots);
+    for (uint32_t i = 0; i < header.pending_slots && valid; i++)
+    {
+      EventRecord record = read_record<EventRecord>(pending_table, i);
+      if (!record.live)
+      {
+        layout.free_pending_slots.push_back(i);
+        continue;
+      }
+
+      valid = record.organizer < users.size();
+      if (!valid)
+        break;
+
+      shared_ptr<User> requester = users[record.organizer];
+      ReservationRequest request(DateTime(read_field(record.date), read_field(record.time)),
+                                 static_cast<Event::LayoutType>(record.layout), static_cast<Event::GuestType>(record.guest_type),
+                                 record.is_public, record.price_per_ticket, record.duration, record_payment(record), requester);
+      Layout::EventSlot slot = {i, request.get_version(), 0, 0};
+      layout.pending[pending_key(request, record.organizer)] = slot;
+      state.pending_events.push_back(request);
+    }
+
+    if (!valid)
+    {
+      cout << "Snapshot has an invalid user handle, loading CSVs instead." << endl;
+      state = State();
+      layout = Layout();
+      return false;
+    }
+    layout.valid = true;
+    return true;
+  }
+
+  bool save(const UserDirectory &users, const Schedule &confirmed_events,
+            const PendingRequests &pending_events, Layout &layout)
+  {
+    if (layout.valid && save_changes(users, confirmed_events, pending_events, layout))
+      return true;
+    return save_full(users, confirmed_events, pending_events, layout);
+  }
+}
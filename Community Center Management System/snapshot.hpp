@@ -0,0 +1,89 @@
+#pragma once
+
+#include "User.hpp"
+#include "Event.hpp"
+#include "ReservationRequest.hpp"
+#include "PendingRequests.hpp"
+#include "UserDirectory.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+using namespace std;
+
+// Binary snapshot of the whole program state, used for fast restarts. The CSVs in program_data
+// stay the import/export format; the snapshot is only preferred when it is newer than all of them.
+namespace snapshot
+{
+  /**
+   * The program state stored in a snapshot.
+   */
+  struct State
+  {
+    UserDirectory users;
+    vector<shared_ptr<Event>> confirmed_events;
+    vector<ReservationRequest> pending_events;
+  };
+
+  /**
+   * Where each record lives in the snapshot file and which version of it was written there. Records
+   * sit at fixed offsets in preallocated tables, so a save only rewrites the records whose version
+   * has changed since the last load or save.
+   */
+  struct Layout
+  {
+    struct EventSlot
+    {
+      uint32_t slot;
+      unsigned long version;
+      uint32_t span_begin; // the ticket and waitlist handles of the event, in the handle pool
+      uint32_t span_capacity;
+    };
+
+    bool valid = false; // does this describe the snapshot file on disk
+    uint32_t user_count = 0; // users are only ever appended, in UserDirectory order
+    uint32_t user_capacity = 0;
+    uint32_t event_slots = 0; // event slots ever used, including freed ones
+    uint32_t event_capacity = 0;
+    uint32_t pending_slots = 0;
+    uint32_t pending_capacity = 0;
+    uint32_t handle_used = 0;
+    uint32_t handle_capacity = 0;
+    unordered_map<long long, EventSlot> events;      // event start minute to slot
+    unordered_map<long long, EventSlot> pending;     // request start minute and requester to slot
+    vector<uint32_t> free_event_slots;
+    vector<uint32_t> free_pending_slots;
+  };
+
+  /**
+   * Is the snapshot file newer than every CSV in program_data?
+   *
+   * @return is the snapshot present and up to date with the CSVs
+   */
+  bool is_fresh();
+
+  /**
+   * Loads the program state from the snapshot file with a single read. Users are referenced by
+   * their integer handle inside the snapshot, so no usernames are resolved while loading.
+   *
+   * @param state the state to fill; it is left empty if the snapshot is missing or invalid
+   * @param layout the layout of the loaded file, used to save changes in place later
+   * @return was the snapshot loaded
+   */
+  bool load(State &state, Layout &layout);
+
+  /**
+   * Saves the program state to the snapshot file. If the layout describes the file on disk, only
+   * records that changed since are written; otherwise the whole file is rewritten.
+   *
+   * @param users the Users in the program
+   * @param confirmed_events the confirmed Events
+   * @param pending_events the Events pending confirmation
+   * @param layout the layout of the file on disk, updated to match what was written
+   * @return was the snapshot saved
+   */
+  bool save(const UserDirectory &users, const Schedule &confirmed_events,
+            const PendingRequests &pending_events, Layout &layout);
+}